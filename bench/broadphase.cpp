@@ -0,0 +1,766 @@
+// Broadphase benchmark suite: finds every overlapping pair of particles in
+// three distributions inside the constraint sphere (uniform, clustered and a
+// settled pile) with four broadphases and reports pairs found, time per
+// particle and memory, as JSON on stdout for trend tracking. A readable
+// table goes to stderr.
+//
+//   brute    the O(n^2) pair loop Physx::update used to run
+//   hash     SpatialHash, the grid with the hashCoords primes Physx uses now
+//   sweep    sort-and-sweep along the axis the particles spread most on
+//   bvh      dynamic AABB tree with fattened leaves, updated incrementally
+//
+// Every method runs a first frame (build) and then `frames` frames with the
+// particles jittered a little in between, updating whatever it keeps from
+// the last frame the way it would in the solver: the hash is rebuilt, the
+// sweep re-sorts an almost sorted order with insertion sort, and the tree
+// only reinserts leaves that left their fattened box.
+//
+// Usage: physxgl_bench_broadphase [--counts 1000,10000,100000] [--frames N]
+//                                 [--max-brute N] [--seed N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "json.h"
+#include "spatialHash.h"
+
+using json = nlohmann::json;
+
+struct BenchSettings
+{
+    std::vector<int> counts = {1000, 10000, 100000};
+    int frames = 10;
+    int maxBrute = 10000; // Brute force at 100k takes minutes
+    unsigned int seed = 1234;
+};
+
+const float particleRadius = 0.1f;
+
+// ------------------------------------------------------------------------
+// Distributions, all inside the sphere Particle::constraint keeps them in
+// ------------------------------------------------------------------------
+
+glm::vec3 randomInSphere(std::mt19937 &gen, float radius)
+{
+    std::uniform_real_distribution<float> dis(-radius, radius);
+    while (true)
+    {
+        glm::vec3 p(dis(gen), dis(gen), dis(gen));
+        if (glm::length(p) <= radius)
+            return p;
+    }
+}
+
+std::vector<glm::vec3> uniformPoints(int count, float radius, std::mt19937 &gen)
+{
+    std::vector<glm::vec3> points;
+    points.reserve(count);
+    while ((int)points.size() < count)
+        points.push_back(randomInSphere(gen, radius));
+    return points;
+}
+
+// A few dense blobs, like what an emitter or a splash leaves behind
+std::vector<glm::vec3> clusteredPoints(int count, float radius, std::mt19937 &gen)
+{
+    const int clusters = 16;
+    std::vector<glm::vec3> centres;
+    for (int c = 0; c < clusters; c++)
+        centres.push_back(randomInSphere(gen, radius * 0.8f));
+
+    std::normal_distribution<float> spread(0.0f, radius * 0.08f);
+    std::uniform_int_distribution<int> pick(0, clusters - 1);
+
+    std::vector<glm::vec3> points;
+    points.reserve(count);
+    while ((int)points.size() < count)
+    {
+        glm::vec3 p = centres[pick(gen)] + glm::vec3(spread(gen), spread(gen), spread(gen));
+        if (glm::length(p) <= radius)
+            points.push_back(p);
+    }
+    return points;
+}
+
+// What a pile looks like once it has settled: a jittered lattice one
+// diameter apart filling the bottom of the sphere, every particle touching
+// its neighbours with the slight overlap a solver leaves
+std::vector<glm::vec3> pilePoints(int count, float radius, std::mt19937 &gen)
+{
+    float spacing = particleRadius * 2 * 0.99f;
+    int steps = (int)std::ceil(radius / spacing);
+
+    std::vector<glm::vec3> lattice;
+    for (int xi = -steps; xi <= steps; xi++)
+        for (int yi = -steps; yi <= steps; yi++)
+            for (int zi = -steps; zi <= steps; zi++)
+            {
+                glm::vec3 p = glm::vec3(xi, yi, zi) * spacing;
+                if (glm::length(p) <= radius - particleRadius)
+                    lattice.push_back(p);
+            }
+
+    // Lowest first, it fills up from the bottom
+    std::stable_sort(lattice.begin(), lattice.end(), [](const glm::vec3 &a, const glm::vec3 &b)
+                     { return a.y < b.y; });
+    lattice.resize(std::min((int)lattice.size(), count));
+
+    std::uniform_real_distribution<float> jitter(-0.01f * particleRadius, 0.01f * particleRadius);
+    for (glm::vec3 &p : lattice)
+        p += glm::vec3(jitter(gen), jitter(gen), jitter(gen));
+    return lattice;
+}
+
+// ------------------------------------------------------------------------
+// Broadphases. Every one counts the pairs closer than a diameter, each once
+// ------------------------------------------------------------------------
+
+class Broadphase
+{
+public:
+    virtual ~Broadphase() = default;
+    virtual const char *name() const = 0;
+    // First frame, nothing to reuse
+    virtual long long build(const std::vector<glm::vec3> &points) = 0;
+    // Later frames, the particles moved a little since the last call
+    virtual long long update(const std::vector<glm::vec3> &points) { return build(points); }
+    virtual size_t memoryBytes() const = 0;
+};
+
+class BruteForce : public Broadphase
+{
+public:
+    const char *name() const override { return "brute"; }
+
+    long long build(const std::vector<glm::vec3> &points) override
+    {
+        float minDist2 = particleRadius * particleRadius * 4;
+        long long pairs = 0;
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            for (size_t j = i + 1; j < points.size(); j++)
+            {
+                glm::vec3 d = points[j] - points[i];
+                if (glm::dot(d, d) < minDist2)
+                    pairs++;
+            }
+        }
+        return pairs;
+    }
+
+    size_t memoryBytes() const override { return 0; }
+};
+
+class HashGrid : public Broadphase
+{
+public:
+    const char *name() const override { return "hash"; }
+
+    long long build(const std::vector<glm::vec3> &points) override
+    {
+        int n = (int)points.size();
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        for (int i = 0; i < n; i++)
+        {
+            x[i] = points[i].x;
+            y[i] = points[i].y;
+            z[i] = points[i].z;
+        }
+
+        hash.create(n, x.data(), y.data(), z.data());
+
+        float minDist2 = particleRadius * particleRadius * 4;
+        long long pairs = 0;
+        for (int i = 0; i < n; i++)
+        {
+            hash.query(points[i], particleRadius * 2, queryIds);
+            for (int j : queryIds)
+            {
+                glm::vec3 d = points[j] - points[i];
+                if (j > i && glm::dot(d, d) < minDist2)
+                    pairs++;
+            }
+        }
+        return pairs;
+    }
+
+    size_t memoryBytes() const override
+    {
+        return (hash.cellStart.capacity() + hash.particleMap.capacity()) * sizeof(int) +
+               (x.capacity() + y.capacity() + z.capacity()) * sizeof(float);
+    }
+
+private:
+    SpatialHash hash = SpatialHash(particleRadius * 2, 512);
+    std::vector<float> x, y, z;
+    std::vector<int> queryIds;
+};
+
+class SortAndSweep : public Broadphase
+{
+public:
+    const char *name() const override { return "sweep"; }
+
+    long long build(const std::vector<glm::vec3> &points) override
+    {
+        // Sweep along the axis the particles spread most on, fewest false candidates
+        glm::vec3 mean(0.0f);
+        for (const glm::vec3 &p : points)
+            mean += p;
+        mean = mean * (1.0f / std::max<size_t>(points.size(), 1));
+        glm::vec3 variance(0.0f);
+        for (const glm::vec3 &p : points)
+            variance += (p - mean) * (p - mean);
+        axis = variance.x >= variance.y && variance.x >= variance.z ? 0 : (variance.y >= variance.z ? 1 : 2);
+
+        order.resize(points.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = (int)i;
+        loadKeys(points);
+        std::sort(order.begin(), order.end(), [&](int a, int b)
+                  { return keys[a] < keys[b]; });
+        return sweep(points);
+    }
+
+    long long update(const std::vector<glm::vec3> &points) override
+    {
+        if (order.size() != points.size())
+            return build(points);
+
+        // Last frame's order is almost right, insertion sort fixes it in close to linear time
+        loadKeys(points);
+        for (size_t k = 1; k < order.size(); k++)
+        {
+            int i = order[k];
+            size_t m = k;
+            while (m > 0 && keys[order[m - 1]] > keys[i])
+            {
+                order[m] = order[m - 1];
+                m--;
+            }
+            order[m] = i;
+        }
+        return sweep(points);
+    }
+
+    size_t memoryBytes() const override { return order.capacity() * sizeof(int) + keys.capacity() * sizeof(float); }
+
+private:
+    int axis = 0;
+    std::vector<int> order;
+    std::vector<float> keys;
+
+    void loadKeys(const std::vector<glm::vec3> &points)
+    {
+        keys.resize(points.size());
+        for (size_t i = 0; i < points.size(); i++)
+            keys[i] = points[i][axis];
+    }
+
+    long long sweep(const std::vector<glm::vec3> &points) const
+    {
+        float minDist = particleRadius * 2;
+        float minDist2 = minDist * minDist;
+        long long pairs = 0;
+        for (size_t k = 0; k < order.size(); k++)
+        {
+            int i = order[k];
+            for (size_t m = k + 1; m < order.size() && keys[order[m]] - keys[i] < minDist; m++)
+            {
+                glm::vec3 d = points[order[m]] - points[i];
+                if (glm::dot(d, d) < minDist2)
+                    pairs++;
+            }
+        }
+        return pairs;
+    }
+};
+
+// Dynamic AABB tree in the style of Box2D's b2DynamicTree: leaves hold boxes
+// fattened by a margin so small moves don't touch the tree, inserts descend
+// by the surface area heuristic and rotations keep it balanced.
+class DynamicBvh : public Broadphase
+{
+public:
+    const char *name() const override { return "bvh"; }
+
+    long long build(const std::vector<glm::vec3> &points) override
+    {
+        nodes.clear();
+        freeNode = -1;
+        root = -1;
+        leaves.assign(points.size(), -1);
+        for (size_t i = 0; i < points.size(); i++)
+            leaves[i] = insert((int)i, fatBox(points[i]));
+        return findPairs(points);
+    }
+
+    long long update(const std::vector<glm::vec3> &points) override
+    {
+        if (leaves.size() != points.size())
+            return build(points);
+
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            if (contains(nodes[leaves[i]].box, tightBox(points[i])))
+                continue;
+            remove(leaves[i]);
+            leaves[i] = insert((int)i, fatBox(points[i]));
+        }
+        return findPairs(points);
+    }
+
+    size_t memoryBytes() const override
+    {
+        return nodes.capacity() * sizeof(Node) + leaves.capacity() * sizeof(int) + stack.capacity() * sizeof(int);
+    }
+
+private:
+    struct Box
+    {
+        glm::vec3 lo;
+        glm::vec3 hi;
+    };
+
+    struct Node
+    {
+        Box box;
+        int parent;
+        int child1; // -1 for leaves
+        int child2;
+        int height; // 0 for leaves, -1 for free nodes
+        int item;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> leaves; // Leaf node of every particle
+    std::vector<int> stack;
+    int root = -1;
+    int freeNode = -1; // Free nodes are chained through parent
+
+    static Box tightBox(const glm::vec3 &p) { return {p - glm::vec3(particleRadius), p + glm::vec3(particleRadius)}; }
+    static Box fatBox(const glm::vec3 &p)
+    {
+        glm::vec3 r(particleRadius * 1.5f);
+        return {p - r, p + r};
+    }
+    static Box merge(const Box &a, const Box &b) { return {glm::min(a.lo, b.lo), glm::max(a.hi, b.hi)}; }
+    static float area(const Box &b)
+    {
+        glm::vec3 d = b.hi - b.lo;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+    static bool contains(const Box &outer, const Box &inner)
+    {
+        return outer.lo.x <= inner.lo.x && outer.lo.y <= inner.lo.y && outer.lo.z <= inner.lo.z &&
+               outer.hi.x >= inner.hi.x && outer.hi.y >= inner.hi.y && outer.hi.z >= inner.hi.z;
+    }
+    static bool overlaps(const Box &a, const Box &b)
+    {
+        return a.lo.x <= b.hi.x && a.lo.y <= b.hi.y && a.lo.z <= b.hi.z &&
+               b.lo.x <= a.hi.x && b.lo.y <= a.hi.y && b.lo.z <= a.hi.z;
+    }
+
+    int allocate()
+    {
+        if (freeNode < 0)
+        {
+            nodes.push_back(Node());
+            freeNode = (int)nodes.size() - 1;
+            nodes[freeNode].parent = -1;
+        }
+        int id = freeNode;
+        freeNode = nodes[id].parent;
+        nodes[id] = {Box(), -1, -1, -1, 0, -1};
+        return id;
+    }
+
+    void release(int id)
+    {
+        nodes[id].parent = freeNode;
+        nodes[id].height = -1;
+        freeNode = id;
+    }
+
+    int insert(int item, const Box &box)
+    {
+        int leaf = allocate();
+        nodes[leaf].box = box;
+        nodes[leaf].item = item;
+
+        if (root < 0)
+        {
+            root = leaf;
+            return leaf;
+        }
+
+        // Walk down to the sibling that grows the total area least
+        int index = root;
+        while (nodes[index].child1 >= 0)
+        {
+            int child1 = nodes[index].child1;
+            int child2 = nodes[index].child2;
+
+            float combined = area(merge(nodes[index].box, box));
+            float cost = 2.0f * combined;
+            float inheritance = 2.0f * (combined - area(nodes[index].box));
+
+            auto descendCost = [&](int child)
+            {
+                float grown = area(merge(box, nodes[child].box));
+                if (nodes[child].child1 < 0)
+                    return grown + inheritance;
+                return grown - area(nodes[child].box) + inheritance;
+            };
+            float cost1 = descendCost(child1);
+            float cost2 = descendCost(child2);
+
+            if (cost < cost1 && cost < cost2)
+                break;
+            index = cost1 < cost2 ? child1 : child2;
+        }
+
+        int sibling = index;
+        int oldParent = nodes[sibling].parent;
+        int newParent = allocate();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].box = merge(box, nodes[sibling].box);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent >= 0)
+        {
+            if (nodes[oldParent].child1 == sibling)
+                nodes[oldParent].child1 = newParent;
+            else
+                nodes[oldParent].child2 = newParent;
+        }
+        else
+        {
+            root = newParent;
+        }
+
+        refit(nodes[leaf].parent);
+        return leaf;
+    }
+
+    void remove(int leaf)
+    {
+        if (leaf == root)
+        {
+            root = -1;
+            release(leaf);
+            return;
+        }
+
+        int parent = nodes[leaf].parent;
+        int grandParent = nodes[parent].parent;
+        int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        if (grandParent >= 0)
+        {
+            if (nodes[grandParent].child1 == parent)
+                nodes[grandParent].child1 = sibling;
+            else
+                nodes[grandParent].child2 = sibling;
+            nodes[sibling].parent = grandParent;
+            release(parent);
+            refit(grandParent);
+        }
+        else
+        {
+            root = sibling;
+            nodes[sibling].parent = -1;
+            release(parent);
+        }
+        release(leaf);
+    }
+
+    // Walks up from index, rebalancing and recomputing boxes and heights
+    void refit(int index)
+    {
+        while (index >= 0)
+        {
+            index = balance(index);
+
+            int child1 = nodes[index].child1;
+            int child2 = nodes[index].child2;
+            nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+            nodes[index].box = merge(nodes[child1].box, nodes[child2].box);
+
+            index = nodes[index].parent;
+        }
+    }
+
+    // Rotates the taller grandchild up when a's children differ in height by
+    // more than one, returns the node now in a's place
+    int balance(int a)
+    {
+        if (nodes[a].child1 < 0 || nodes[a].height < 2)
+            return a;
+
+        int b = nodes[a].child1;
+        int c = nodes[a].child2;
+        int diff = nodes[c].height - nodes[b].height;
+
+        if (diff > 1)
+            return rotate(a, c, b, true);
+        if (diff < -1)
+            return rotate(a, b, c, false);
+        return a;
+    }
+
+    // Lifts up (a child of a) into a's place, other is a's other child.
+    // upIsChild2 says which slot of a up was in.
+    int rotate(int a, int up, int other, bool upIsChild2)
+    {
+        int f = nodes[up].child1;
+        int g = nodes[up].child2;
+
+        nodes[up].child1 = a;
+        nodes[up].parent = nodes[a].parent;
+        nodes[a].parent = up;
+
+        if (nodes[up].parent >= 0)
+        {
+            int p = nodes[up].parent;
+            if (nodes[p].child1 == a)
+                nodes[p].child1 = up;
+            else
+                nodes[p].child2 = up;
+        }
+        else
+        {
+            root = up;
+        }
+
+        // The taller grandchild stays under up, the shorter one takes up's old slot in a
+        int keep = nodes[f].height > nodes[g].height ? f : g;
+        int move = keep == f ? g : f;
+
+        nodes[up].child2 = keep;
+        if (upIsChild2)
+            nodes[a].child2 = move;
+        else
+            nodes[a].child1 = move;
+        nodes[move].parent = a;
+
+        nodes[a].box = merge(nodes[other].box, nodes[move].box);
+        nodes[a].height = 1 + std::max(nodes[other].height, nodes[move].height);
+        nodes[up].box = merge(nodes[a].box, nodes[keep].box);
+        nodes[up].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+        return up;
+    }
+
+    long long findPairs(const std::vector<glm::vec3> &points)
+    {
+        float minDist2 = particleRadius * particleRadius * 4;
+        long long pairs = 0;
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            Box query = tightBox(points[i]);
+            stack.clear();
+            stack.push_back(root);
+            while (!stack.empty())
+            {
+                int index = stack.back();
+                stack.pop_back();
+                if (index < 0 || !overlaps(nodes[index].box, query))
+                    continue;
+
+                if (nodes[index].child1 < 0)
+                {
+                    int j = nodes[index].item;
+                    glm::vec3 d = points[j] - points[i];
+                    if (j > (int)i && glm::dot(d, d) < minDist2)
+                        pairs++;
+                }
+                else
+                {
+                    stack.push_back(nodes[index].child1);
+                    stack.push_back(nodes[index].child2);
+                }
+            }
+        }
+        return pairs;
+    }
+};
+
+// ------------------------------------------------------------------------
+
+bool parseArgs(int argc, char *argv[], BenchSettings &settings)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+            return false;
+        if (value == nullptr)
+        {
+            std::fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+
+        if (std::strcmp(arg, "--counts") == 0)
+        {
+            settings.counts.clear();
+            const char *p = value;
+            while (*p != '\0')
+            {
+                char *end;
+                int count = (int)std::strtol(p, &end, 10);
+                if (end == p || count <= 0)
+                    return false;
+                settings.counts.push_back(count);
+                p = *end == ',' ? end + 1 : end;
+            }
+        }
+        else if (std::strcmp(arg, "--frames") == 0)
+            settings.frames = std::max(std::atoi(value), 1);
+        else if (std::strcmp(arg, "--max-brute") == 0)
+            settings.maxBrute = std::atoi(value);
+        else if (std::strcmp(arg, "--seed") == 0)
+            settings.seed = (unsigned int)std::strtoul(value, nullptr, 10);
+        else
+        {
+            std::fprintf(stderr, "Unknown option %s\n", arg);
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+void checkPairs(const char *method, const char *frame, long long pairs, long long &expected)
+{
+    if (expected < 0)
+        expected = pairs;
+    else if (pairs != expected)
+        std::fprintf(stderr, "%s found %lld pairs on the %s, expected %lld\n", method, pairs, frame, expected);
+}
+
+template <typename F>
+double timeNs(F &&f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char *argv[])
+{
+    BenchSettings settings;
+    if (!parseArgs(argc, argv, settings))
+    {
+        std::fprintf(stderr, "Usage: physxgl_bench_broadphase [--counts 1000,10000,100000] [--frames N] [--max-brute N] [--seed N]\n");
+        return 1;
+    }
+
+    struct Distribution
+    {
+        const char *name;
+        std::vector<glm::vec3> (*generate)(int, float, std::mt19937 &);
+    };
+    const Distribution distributions[] = {{"uniform", uniformPoints}, {"clustered", clusteredPoints}, {"pile", pilePoints}};
+
+    json results = json::array();
+    std::fprintf(stderr, "%10s %10s %6s %12s %12s %12s %12s\n", "dist", "particles", "method", "pairs", "build ns/p", "frame ns/p", "memory KB");
+
+    for (const Distribution &distribution : distributions)
+    {
+        for (int count : settings.counts)
+        {
+            // Grow the container with the count so density stays at roughly 30% packing
+            float constraintRadius = std::cbrt(count / 0.3f) * particleRadius;
+
+            std::mt19937 gen(settings.seed);
+            std::vector<glm::vec3> start = distribution.generate(count, constraintRadius, gen);
+            int n = (int)start.size();
+
+            BruteForce brute;
+            HashGrid hash;
+            SortAndSweep sweep;
+            DynamicBvh bvh;
+            Broadphase *methods[] = {&brute, &hash, &sweep, &bvh};
+
+            // Every method must find the same pairs, checked against the first one that ran.
+            // The brute force only runs the build frame so the last frame is checked separately.
+            long long expectedBuild = -1;
+            long long expectedFrame = -1;
+            for (Broadphase *method : methods)
+            {
+                bool isBrute = method == &brute;
+                if (isBrute && n > settings.maxBrute)
+                    continue;
+
+                // Same jitter sequence for every method, a small step's worth of motion
+                std::mt19937 jitterGen(settings.seed + 1);
+                std::uniform_real_distribution<float> jitter(-0.05f * particleRadius, 0.05f * particleRadius);
+                std::vector<glm::vec3> points = start;
+
+                long long pairs = 0;
+                double buildNs = timeNs([&]
+                                        { pairs = method->build(points); });
+                checkPairs(method->name(), "build", pairs, expectedBuild);
+                long long buildPairs = pairs;
+
+                // Brute force has nothing to reuse and is far too slow to repeat
+                int frames = isBrute ? 0 : settings.frames;
+                double frameNs = isBrute ? buildNs : 0.0;
+                for (int f = 0; f < frames; f++)
+                {
+                    for (glm::vec3 &p : points)
+                        p += glm::vec3(jitter(jitterGen), jitter(jitterGen), jitter(jitterGen));
+                    frameNs += timeNs([&]
+                                      { pairs = method->update(points); });
+                }
+                if (frames > 0)
+                    frameNs /= frames;
+
+                if (frames > 0)
+                    checkPairs(method->name(), "last frame", pairs, expectedFrame);
+
+                json result;
+                result["distribution"] = distribution.name;
+                result["particles"] = n;
+                result["containerRadius"] = constraintRadius;
+                result["method"] = method->name();
+                result["pairs"] = buildPairs;
+                result["lastFramePairs"] = pairs;
+                result["buildNsPerParticle"] = buildNs / n;
+                result["frameNsPerParticle"] = frameNs / n;
+                result["frames"] = frames;
+                result["memoryBytes"] = method->memoryBytes();
+                results.push_back(result);
+
+                std::fprintf(stderr, "%10s %10d %6s %12lld %12.1f %12.1f %12.1f\n", distribution.name, n, method->name(), buildPairs,
+                             buildNs / n, frameNs / n, method->memoryBytes() / 1024.0);
+            }
+        }
+    }
+
+    json report;
+    report["benchmark"] = "broadphase";
+    report["particleRadius"] = particleRadius;
+    report["frames"] = settings.frames;
+    report["seed"] = settings.seed;
+    report["results"] = results;
+    std::printf("%s\n", report.dump(2).c_str());
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Times the integration, constraint and contact kernels for every ISA the CPU
+// supports and checks each one against the scalar kernels. Exits with a
+// failure if any result differs from scalar by more than the tolerance.
+//
+// Usage: physxgl_bench_simd [particles] [steps]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "simdKernels.h"
+
+const float tolerance = 1e-5f;
+
+void spawnParticles(ParticleSystem &ps, int count, float constraintRadius)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> pos(-constraintRadius * 1.2f, constraintRadius * 1.2f);
+    std::uniform_real_distribution<float> vel(-2.0f, 2.0f);
+
+    ps.clear();
+    for (int i = 0; i < count; i++)
+    {
+        // Some particles start at rest to exercise the friction and resting branches
+        glm::vec3 v = i % 7 == 0 ? glm::vec3(0) : glm::vec3(vel(gen), vel(gen), vel(gen));
+        ps.spawn(glm::vec3(pos(gen), pos(gen), pos(gen)), v, 0.1f);
+    }
+}
+
+float maxDifference(const ParticleSystem &a, const ParticleSystem &b)
+{
+    const std::vector<float> ParticleSystem::*arrays[] = {
+        &ParticleSystem::x, &ParticleSystem::y, &ParticleSystem::z,
+        &ParticleSystem::vx, &ParticleSystem::vy, &ParticleSystem::vz,
+        &ParticleSystem::ax, &ParticleSystem::ay, &ParticleSystem::az};
+
+    float diff = 0.0f;
+    for (auto array : arrays)
+    {
+        for (size_t i = 0; i < a.size(); i++)
+            diff = std::max(diff, std::fabs((a.*array)[i] - (b.*array)[i]));
+    }
+    return diff;
+}
+
+// Runs every kernel for the given number of steps, returns ms per step and the number of contacts found
+double runKernels(const SimdKernels &kernels, ParticleSystem &ps, int steps, long long &contacts)
+{
+    const float constraintRadius = 3.1f;
+    const float dt = 1.0f / 120.0f;
+    int n = (int)ps.size();
+
+    // A fixed candidate list per particle, like the hash query would hand out
+    std::vector<int> ids(32), hits(32);
+
+    contacts = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int s = 0; s < steps; s++)
+    {
+        kernels.integrate(ps, dt, 9.81f, 0, n);
+        kernels.constraint(ps, constraintRadius, 0, n);
+
+        for (int i = 0; i < n; i += 16)
+        {
+            for (int k = 0; k < 32; k++)
+                ids[k] = (i + k * 37) % n;
+            contacts += kernels.findContacts(ps, i, ids.data(), 32, 1.0f, hits.data());
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / steps;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 100003; // Not a multiple of 8, so the scalar tails run too
+    int steps = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    ParticleSystem reference;
+    spawnParticles(reference, count, 3.1f);
+    long long referenceContacts = 0;
+    double scalarMs = runKernels(simdKernels(SimdLevel::Scalar), reference, steps, referenceContacts);
+
+    std::printf("%d particles, %d steps, dispatching to %s\n", count, steps, simdKernels().name);
+    std::printf("%8s %10s %10s %14s %10s\n", "kernels", "ms/step", "speedup", "max |diff|", "contacts");
+    std::printf("%8s %10.3f %9.2fx %14g %10lld\n", "scalar", scalarMs, 1.0, 0.0, referenceContacts);
+
+    bool ok = true;
+    const SimdLevel levels[] = {SimdLevel::SSE, SimdLevel::AVX2, SimdLevel::NEON};
+    for (SimdLevel level : levels)
+    {
+        if (!simdSupported(level))
+            continue;
+
+        const SimdKernels &kernels = simdKernels(level);
+        ParticleSystem ps;
+        spawnParticles(ps, count, 3.1f);
+        long long contacts = 0;
+        double ms = runKernels(kernels, ps, steps, contacts);
+        float diff = maxDifference(reference, ps);
+
+        bool pass = diff <= tolerance && contacts == referenceContacts;
+        ok = ok && pass;
+        std::printf("%8s %10.3f %9.2fx %14g %10lld %s\n", kernels.name, ms, scalarMs / ms, diff, contacts, pass ? "" : "MISMATCH");
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+// Drops the same pile with sleeping off and on and reports what a step costs
+// while the pile falls and once it has settled, the step at which the last
+// particle fell asleep, how many are still awake at the end and whether the
+// settled pile holds together as well. The defaults give the pile time to
+// fall asleep well before the settled quarter of the run starts.
+//
+// Usage: physxgl_bench_sleep [particles] [steps] [subSteps] [xpbd 0|1]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "physx.h"
+
+// Random in the upper half of the container, so everything falls and piles up
+void spawnPile(ParticleSystem &ps, int count, float constraintRadius, float particleRadius)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> dis(-constraintRadius, constraintRadius);
+
+    ps.clear();
+    ps.reserve(count);
+    while ((int)ps.size() < count)
+    {
+        glm::vec3 p(dis(gen), std::abs(dis(gen)), dis(gen));
+        if (glm::length(p) <= constraintRadius)
+            ps.spawn(p, glm::vec3(0), particleRadius);
+    }
+}
+
+// Mean overlap over touching pairs, as a fraction of the diameter
+double meanOverlap(const ParticleSystem &ps, float pr)
+{
+    int n = (int)ps.size();
+    SpatialHash hash(pr * 2, n);
+    hash.create(n, ps.x.data(), ps.y.data(), ps.z.data());
+
+    std::vector<int> queryIds;
+    double overlap = 0.0;
+    long long pairs = 0;
+    for (int i = 0; i < n; i++)
+    {
+        glm::vec3 p(ps.x[i], ps.y[i], ps.z[i]);
+        hash.query(p, pr * 2, queryIds);
+        for (int j : queryIds)
+        {
+            if (j <= i)
+                continue;
+            float dist = glm::distance(p, glm::vec3(ps.x[j], ps.y[j], ps.z[j]));
+            if (dist < pr * 2)
+            {
+                overlap += (pr * 2 - dist) / (pr * 2);
+                pairs++;
+            }
+        }
+    }
+    return pairs > 0 ? overlap / pairs : 0.0;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 2000;
+    int subSteps = argc > 3 ? std::atoi(argv[3]) : 4;
+    bool xpbd = argc > 4 ? std::atoi(argv[4]) != 0 : true;
+
+    const float particleRadius = 0.1f;
+    const float constraintRadius = std::cbrt(count / 0.3f) * particleRadius;
+    const float dt = 1.0f / 120.0f;
+
+    std::printf("%d particles, %d steps of %.4f s, %d substeps, %s contacts\n", count, steps, dt, subSteps, xpbd ? "XPBD" : "impulse");
+    std::printf("Falling is the first quarter of the run, settled the last\n");
+    std::printf("%9s %12s %12s %10s %9s %12s\n", "sleeping", "falling ms", "settled ms", "asleep at", "awake", "mean ovl %");
+
+    for (int sleeping = 0; sleeping < 2; sleeping++)
+    {
+        Physx physx;
+        physx.contactModel = xpbd ? ContactModel::Xpbd : ContactModel::Impulse;
+        physx.sleeping = sleeping != 0;
+
+        ParticleSystem ps;
+        spawnPile(ps, count, constraintRadius, particleRadius);
+
+        double falling = 0.0;
+        double settled = 0.0;
+        int asleepAt = -1; // First step that ended with every particle asleep
+        for (int s = 0; s < steps; s++)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            physx.update(ps, particleRadius, dt, 9.81f, constraintRadius, subSteps);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+            if (s < steps / 4)
+                falling += ms;
+            else if (s >= steps - steps / 4)
+                settled += ms;
+
+            if (asleepAt < 0 && physx.sleeping && physx.awakeCount() == 0)
+                asleepAt = s + 1;
+        }
+
+        int quarter = std::max(steps / 4, 1);
+        char asleep[16] = "-";
+        if (asleepAt >= 0)
+            std::snprintf(asleep, sizeof(asleep), "%d", asleepAt);
+        std::printf("%9s %12.3f %12.3f %10s %9d %12.2f\n", sleeping ? "on" : "off", falling / quarter, settled / quarter,
+                    asleep, physx.awakeCount(), meanOverlap(ps, particleRadius) * 100.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Drops the same pile of particles into the container at several substep
+// counts and reports what each costs against how well it holds together:
+// how deep particles still overlap, how many were pushed out of the
+// container and how much the settled pile still jitters.
+//
+// Usage: physxgl_bench_substeps [particles] [steps] [maxSubSteps]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "physx.h"
+
+// Random in the upper half of the container, so everything falls and piles up
+void spawnPile(ParticleSystem &ps, int count, float constraintRadius, float particleRadius)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> dis(-constraintRadius, constraintRadius);
+
+    ps.clear();
+    ps.reserve(count);
+    while ((int)ps.size() < count)
+    {
+        glm::vec3 p(dis(gen), std::abs(dis(gen)), dis(gen));
+        if (glm::length(p) <= constraintRadius)
+            ps.spawn(p, glm::vec3(0), particleRadius);
+    }
+}
+
+struct Stability
+{
+    double meanOverlap = 0.0;   // Over touching pairs, as a fraction of the diameter
+    double maxOverlap = 0.0;
+    int escaped = 0;            // More than half a radius outside the container
+    double kineticEnergy = 0.0; // Per particle, unit mass
+    bool finite = true;
+};
+
+Stability measure(const ParticleSystem &ps, float pr, float constraintRadius)
+{
+    Stability s;
+    int n = (int)ps.size();
+
+    SpatialHash hash(pr * 2, n);
+    hash.create(n, ps.x.data(), ps.y.data(), ps.z.data());
+
+    std::vector<int> queryIds;
+    long long pairs = 0;
+    for (int i = 0; i < n; i++)
+    {
+        glm::vec3 p(ps.x[i], ps.y[i], ps.z[i]);
+        glm::vec3 v(ps.vx[i], ps.vy[i], ps.vz[i]);
+        if (!std::isfinite(p.x + p.y + p.z + v.x + v.y + v.z))
+        {
+            s.finite = false;
+            continue;
+        }
+
+        s.kineticEnergy += 0.5 * glm::dot(v, v);
+        if (glm::length(p) > constraintRadius + pr * 0.5f)
+            s.escaped++;
+
+        hash.query(p, pr * 2, queryIds);
+        for (int j : queryIds)
+        {
+            if (j <= i)
+                continue;
+            float dist = glm::distance(p, glm::vec3(ps.x[j], ps.y[j], ps.z[j]));
+            if (dist < pr * 2)
+            {
+                double overlap = (pr * 2 - dist) / (pr * 2);
+                s.meanOverlap += overlap;
+                s.maxOverlap = std::max(s.maxOverlap, overlap);
+                pairs++;
+            }
+        }
+    }
+
+    if (pairs > 0)
+        s.meanOverlap /= pairs;
+    if (n > 0)
+        s.kineticEnergy /= n;
+    return s;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 240;
+    int maxSubSteps = argc > 3 ? std::atoi(argv[3]) : 16;
+
+    const float particleRadius = 0.1f;
+    const float constraintRadius = std::cbrt(count / 0.3f) * particleRadius;
+    const float dt = 1.0f / 120.0f;
+
+    std::printf("%d particles, %d steps of %.4f s\n", count, steps, dt);
+    std::printf("%9s %10s %12s %12s %9s %12s\n", "substeps", "ms/step", "mean ovl %", "max ovl %", "escaped", "KE/particle");
+
+    Physx physx;
+    for (int subSteps = 1; subSteps <= maxSubSteps; subSteps *= 2)
+    {
+        ParticleSystem ps;
+        spawnPile(ps, count, constraintRadius, particleRadius);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int s = 0; s < steps; s++)
+            physx.update(ps, particleRadius, dt, 9.81f, constraintRadius, subSteps);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        Stability s = measure(ps, particleRadius, constraintRadius);
+        if (!s.finite)
+        {
+            std::printf("%9d %10.3f %12s\n", subSteps, elapsed.count() / steps, "diverged");
+            continue;
+        }
+        std::printf("%9d %10.3f %12.2f %12.2f %9d %12.5f\n", subSteps, elapsed.count() / steps,
+                    s.meanOverlap * 100.0, s.maxOverlap * 100.0, s.escaped, s.kineticEnergy);
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Steps the same scene with Physx on 1..N threads and reports the scaling.
+// Every run starts from identical state and should end with an identical checksum.
+//
+// Usage: physxgl_bench_threads [particles] [steps] [maxThreads]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+#include "physx.h"
+
+void spawnParticles(ParticleSystem &ps, int count, float constraintRadius, float particleRadius)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> dis(-constraintRadius, constraintRadius);
+
+    ps.clear();
+    ps.reserve(count);
+    while ((int)ps.size() < count)
+    {
+        glm::vec3 p(dis(gen), dis(gen), dis(gen));
+        if (glm::length(p) <= constraintRadius)
+            ps.spawn(p, glm::vec3(0), particleRadius);
+    }
+}
+
+double checksum(const ParticleSystem &ps)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < ps.size(); i++)
+        sum += ps.x[i] * 1.0 + ps.y[i] * 2.0 + ps.z[i] * 3.0;
+    return sum;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 20;
+    int maxThreads = argc > 3 ? std::atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+    if (maxThreads < 1)
+        maxThreads = 1;
+
+    const float particleRadius = 0.1f;
+    const float constraintRadius = std::cbrt(count / 0.3f) * particleRadius;
+    const float dt = 1.0f / 120.0f;
+
+    std::printf("%d particles, %d steps\n", count, steps);
+    std::printf("%8s %12s %10s %20s\n", "threads", "ms/step", "speedup", "checksum");
+
+    double baseMs = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        Physx physx(threads);
+        ParticleSystem ps;
+        spawnParticles(ps, count, constraintRadius, particleRadius);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int s = 0; s < steps; s++)
+            physx.update(ps, particleRadius, dt, 9.81f, constraintRadius);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        double ms = elapsed.count() / steps;
+        if (threads == 1)
+            baseMs = ms;
+
+        std::printf("%8d %12.3f %9.2fx %20.6f\n", threads, ms, baseMs / ms, checksum(ps));
+
+        // Always include the full thread count even when it isn't a power of two
+        if (threads < maxThreads && threads * 2 > maxThreads)
+            threads = maxThreads / 2;
+    }
+
+    return 0;
+}
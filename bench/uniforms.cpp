@@ -0,0 +1,258 @@
+// CPU cost of submitting draws, the way the viewer sets uniforms before and
+// after the location tables and the frame uniform block. Every draw switches
+// between a handful of programs, like the particle passes do, and sets the
+// shared per-frame values plus one per-draw matrix:
+//
+//   lookup   glGetUniformLocation with a std::string built per call, as
+//            ComputeShader::set* and the draw code used to
+//   cached   the same uniforms, locations from the UniformTable
+//   block    shared values in one std140 block uploaded once a frame, only
+//            the per-draw matrix set per draw
+//
+// The draws are a single triangle into a 1x1 hidden window, so the time is
+// almost all driver submission. Reported per draw, JSON on stdout, a table
+// on stderr. Run from the repository root, the block program reads
+// res/shaders/common/frame.glsl.
+//
+// Usage: physxgl_bench_uniforms [draws per frame] [frames] [programs]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "frameUniforms.h"
+#include "json.h"
+#include "shaderClass.h"
+#include "uniformBuffer.h"
+
+using json = nlohmann::json;
+
+// The shared values as separate uniforms, the layout before the block
+const char *uniformVertex = R"(#version 430 core
+uniform mat4 camMatrix;
+uniform mat4 model;
+uniform float alpha;
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = camMatrix * model * vec4(corner * alpha, 0.0, 1.0);
+}
+)";
+
+const char *uniformFragment = R"(#version 430 core
+out vec4 FragColor;
+uniform vec3 sunDirection;
+uniform vec3 color;
+uniform vec3 ambient;
+void main() {
+    FragColor = vec4(ambient + color * max(sunDirection.y, 0.0), 1.0);
+}
+)";
+
+const char *blockVertex = R"(
+uniform mat4 model;
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = camMatrix * model * vec4(corner * alpha, 0.0, 1.0);
+}
+)";
+
+const char *blockFragment = R"(
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(ambient + color * max(sunDirection.y, 0.0), 1.0);
+}
+)";
+
+GLuint compileProgram(const std::string &vertexSource, const std::string &fragmentSource)
+{
+    GLuint program = glCreateProgram();
+    const std::string *sources[] = {&vertexSource, &fragmentSource};
+    const GLenum types[] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+    for (int i = 0; i < 2; i++)
+    {
+        GLuint shader = glCreateShader(types[i]);
+        const char *source = sources[i]->c_str();
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+        glAttachShader(program, shader);
+        glDeleteShader(shader);
+    }
+    glLinkProgram(program);
+
+    GLint linked;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        std::printf("Program failed to link:\n%s\n", log);
+        std::exit(EXIT_FAILURE);
+    }
+    return program;
+}
+
+// Location the old way, a std::string per lookup like the const std::string & setters made
+GLint lookup(GLuint program, const std::string &name)
+{
+    return glGetUniformLocation(program, name.c_str());
+}
+
+enum class Mode
+{
+    Lookup,
+    Cached,
+    Block
+};
+
+const char *modeName(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::Lookup:
+        return "lookup";
+    case Mode::Cached:
+        return "cached";
+    default:
+        return "block";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int drawsPerFrame = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 50;
+    int programCount = argc > 3 ? std::max(std::atoi(argv[3]), 1) : 8;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow *window = glfwCreateWindow(1, 1, "physxgl_bench_uniforms", nullptr, nullptr);
+    if (window == nullptr)
+    {
+        std::printf("Failed to create a GL 4.3 context\n");
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::printf("Failed to initialize GLAD\n");
+        return EXIT_FAILURE;
+    }
+
+    std::string frameBlock = "#version 430 core\n" + get_shader_source("res/shaders/common/frame.glsl");
+
+    // Separate programs with identical code, so every draw pays for the switch
+    std::vector<GLuint> uniformPrograms;
+    std::vector<UniformTable> tables(programCount);
+    std::vector<GLuint> blockPrograms;
+    std::vector<UniformTable> blockTables(programCount);
+    for (int p = 0; p < programCount; p++)
+    {
+        uniformPrograms.push_back(compileProgram(uniformVertex, uniformFragment));
+        tables[p].build(uniformPrograms[p]);
+        blockPrograms.push_back(compileProgram(frameBlock + blockVertex, frameBlock + blockFragment));
+        blockTables[p].build(blockPrograms[p]);
+    }
+
+    UniformBuffer<gpu::FrameUniforms> frameUniforms(FRAME_UNIFORMS_BINDING);
+    gpu::FrameUniforms frame = {};
+    frame.camMatrix = glm::mat4(1.0f);
+    frame.alpha = 0.5f;
+    frame.sunDirection = glm::vec3(0.0f, 1.0f, 0.0f);
+    frame.color = glm::vec3(1.0f);
+    frame.ambient = glm::vec3(0.02f);
+
+    GLuint VAO;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glViewport(0, 0, 1, 1);
+
+    json results = json::array();
+    std::fprintf(stderr, "%-8s %12s %12s\n", "mode", "ns/draw", "draws/ms");
+
+    const Mode modes[] = {Mode::Lookup, Mode::Cached, Mode::Block};
+    for (Mode mode : modes)
+    {
+        double best = 1e30;
+        for (int f = 0; f < frames + 1; f++)
+        {
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+
+            if (mode == Mode::Block)
+                frameUniforms.update(frame);
+
+            for (int d = 0; d < drawsPerFrame; d++)
+            {
+                int p = d % programCount;
+                glm::mat4 model(1.0f);
+                model[3][0] = d * 1e-6f;
+
+                if (mode == Mode::Lookup)
+                {
+                    GLuint program = uniformPrograms[p];
+                    glUseProgram(program);
+                    glUniformMatrix4fv(lookup(program, "camMatrix"), 1, GL_FALSE, &frame.camMatrix[0][0]);
+                    glUniform1f(lookup(program, "alpha"), frame.alpha);
+                    glUniform3f(lookup(program, "sunDirection"), frame.sunDirection.x, frame.sunDirection.y, frame.sunDirection.z);
+                    glUniform3f(lookup(program, "color"), frame.color.x, frame.color.y, frame.color.z);
+                    glUniform3f(lookup(program, "ambient"), frame.ambient.x, frame.ambient.y, frame.ambient.z);
+                    glUniformMatrix4fv(lookup(program, "model"), 1, GL_FALSE, &model[0][0]);
+                }
+                else if (mode == Mode::Cached)
+                {
+                    const UniformTable &table = tables[p];
+                    glUseProgram(uniformPrograms[p]);
+                    glUniformMatrix4fv(table.location("camMatrix"), 1, GL_FALSE, &frame.camMatrix[0][0]);
+                    glUniform1f(table.location("alpha"), frame.alpha);
+                    glUniform3f(table.location("sunDirection"), frame.sunDirection.x, frame.sunDirection.y, frame.sunDirection.z);
+                    glUniform3f(table.location("color"), frame.color.x, frame.color.y, frame.color.z);
+                    glUniform3f(table.location("ambient"), frame.ambient.x, frame.ambient.y, frame.ambient.z);
+                    glUniformMatrix4fv(table.location("model"), 1, GL_FALSE, &model[0][0]);
+                }
+                else
+                {
+                    glUseProgram(blockPrograms[p]);
+                    glUniformMatrix4fv(blockTables[p].location("model"), 1, GL_FALSE, &model[0][0]);
+                }
+
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+            }
+
+            // Submission only, the GPU catches up before the next frame starts
+            double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            if (f > 0) // The first frame warms the driver's caches
+                best = std::min(best, elapsed);
+        }
+
+        double perDraw = best / drawsPerFrame;
+        results.push_back({{"mode", modeName(mode)},
+                           {"draws_per_frame", drawsPerFrame},
+                           {"programs", programCount},
+                           {"ns_per_draw", perDraw}});
+        std::fprintf(stderr, "%-8s %12.1f %12.1f\n", modeName(mode), perDraw, 1e6 / perDraw);
+    }
+
+    std::printf("%s\n", results.dump(2).c_str());
+
+    for (int p = 0; p < programCount; p++)
+    {
+        glDeleteProgram(uniformPrograms[p]);
+        glDeleteProgram(blockPrograms[p]);
+    }
+    frameUniforms.Delete();
+    glDeleteVertexArrays(1, &VAO);
+    glfwTerminate();
+    return EXIT_SUCCESS;
+}
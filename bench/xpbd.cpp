@@ -0,0 +1,139 @@
+// Drops the same pile with the impulse and the XPBD contact model at several
+// substep counts and compares what a step costs against how well the pile
+// settles: how deep particles still overlap, how much they still move and how
+// far the total energy drifts once the pile has landed. A settled pile should
+// neither gain energy (jitter) nor keep losing it.
+//
+// Usage: physxgl_bench_xpbd [particles] [steps] [maxSubSteps] [compliance] [damping]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "physx.h"
+
+const float gravity = 9.81f;
+
+// Random in the upper half of the container, so everything falls and piles up
+void spawnPile(ParticleSystem &ps, int count, float constraintRadius, float particleRadius)
+{
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> dis(-constraintRadius, constraintRadius);
+
+    ps.clear();
+    ps.reserve(count);
+    while ((int)ps.size() < count)
+    {
+        glm::vec3 p(dis(gen), std::abs(dis(gen)), dis(gen));
+        if (glm::length(p) <= constraintRadius)
+            ps.spawn(p, glm::vec3(0), particleRadius);
+    }
+}
+
+// Kinetic plus potential energy per particle, unit mass
+double energy(const ParticleSystem &ps)
+{
+    double e = 0.0;
+    for (size_t i = 0; i < ps.size(); i++)
+        e += 0.5 * ((double)ps.vx[i] * ps.vx[i] + (double)ps.vy[i] * ps.vy[i] + (double)ps.vz[i] * ps.vz[i]) +
+             gravity * ps.y[i];
+    return ps.size() > 0 ? e / ps.size() : 0.0;
+}
+
+double kineticEnergy(const ParticleSystem &ps)
+{
+    double e = 0.0;
+    for (size_t i = 0; i < ps.size(); i++)
+        e += 0.5 * ((double)ps.vx[i] * ps.vx[i] + (double)ps.vy[i] * ps.vy[i] + (double)ps.vz[i] * ps.vz[i]);
+    return ps.size() > 0 ? e / ps.size() : 0.0;
+}
+
+// Mean overlap over touching pairs, as a fraction of the diameter
+double meanOverlap(const ParticleSystem &ps, float pr)
+{
+    int n = (int)ps.size();
+    SpatialHash hash(pr * 2, n);
+    hash.create(n, ps.x.data(), ps.y.data(), ps.z.data());
+
+    std::vector<int> queryIds;
+    double overlap = 0.0;
+    long long pairs = 0;
+    for (int i = 0; i < n; i++)
+    {
+        glm::vec3 p(ps.x[i], ps.y[i], ps.z[i]);
+        hash.query(p, pr * 2, queryIds);
+        for (int j : queryIds)
+        {
+            if (j <= i)
+                continue;
+            float dist = glm::distance(p, glm::vec3(ps.x[j], ps.y[j], ps.z[j]));
+            if (dist < pr * 2)
+            {
+                overlap += (pr * 2 - dist) / (pr * 2);
+                pairs++;
+            }
+        }
+    }
+    return pairs > 0 ? overlap / pairs : 0.0;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 3000;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 600;
+    int maxSubSteps = argc > 3 ? std::atoi(argv[3]) : 8;
+    float compliance = argc > 4 ? (float)std::atof(argv[4]) : 0.0f;
+    float damping = argc > 5 ? (float)std::atof(argv[5]) : 0.0f;
+
+    const float particleRadius = 0.1f;
+    const float constraintRadius = std::cbrt(count / 0.3f) * particleRadius;
+    const float dt = 1.0f / 120.0f;
+
+    std::printf("%d particles, %d steps of %.4f s, XPBD compliance %g damping %g\n", count, steps, dt, compliance, damping);
+    std::printf("Drift is the change in KE + PE per particle over the second half of the run\n");
+    std::printf("%8s %9s %10s %12s %12s %12s\n", "model", "substeps", "ms/step", "mean ovl %", "KE/particle", "drift");
+
+    const ContactModel models[] = {ContactModel::Impulse, ContactModel::Xpbd};
+    const char *names[] = {"impulse", "xpbd"};
+
+    for (int subSteps = 1; subSteps <= maxSubSteps; subSteps *= 2)
+    {
+        for (int m = 0; m < 2; m++)
+        {
+            Physx physx;
+            physx.contactModel = models[m];
+            physx.compliance = compliance;
+            physx.damping = damping;
+
+            ParticleSystem ps;
+            spawnPile(ps, count, constraintRadius, particleRadius);
+
+            double settled = 0.0;
+            double elapsed = 0.0;
+            for (int s = 0; s < steps; s++)
+            {
+                if (s == steps / 2)
+                    settled = energy(ps);
+
+                auto start = std::chrono::high_resolution_clock::now();
+                physx.update(ps, particleRadius, dt, gravity, constraintRadius, subSteps);
+                elapsed += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            }
+
+            double e = energy(ps);
+            if (!std::isfinite(e))
+            {
+                std::printf("%8s %9d %10.3f %12s\n", names[m], subSteps, elapsed / steps, "diverged");
+                continue;
+            }
+            std::printf("%8s %9d %10.3f %12.2f %12.5f %+12.5f\n", names[m], subSteps, elapsed / steps,
+                        meanOverlap(ps, particleRadius) * 100.0, kineticEnergy(ps), e - settled);
+        }
+    }
+
+    return 0;
+}
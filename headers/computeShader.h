@@ -4,7 +4,10 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "shaderClass.h"
+
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -17,27 +20,15 @@ public:
     // ------------------------------------------------------------------------
     ComputeShader(const char *computePath)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
+        // 1. retrieve the compute source code (with its #includes) from filePath
         std::string computeCode;
-        std::ifstream cShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        cShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
         try
         {
-            // open files
-            cShaderFile.open(computePath);
-
-            std::stringstream cShaderStream;
-            // read file's buffer contents into streams
-            cShaderStream << cShaderFile.rdbuf();
-            // close file handlers
-            cShaderFile.close();
-            // convert stream into string
-            computeCode = cShaderStream.str();
+            computeCode = get_shader_source(computePath);
         }
-        catch (std::ifstream::failure &e)
+        catch (int e)
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << computePath << " (errno " << e << ")" << std::endl;
         }
         const char *cShaderCode = computeCode.c_str();
         // 2. compile shaders
@@ -53,6 +44,7 @@ public:
         glAttachShader(ID, compute);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        uniforms.build(ID);
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(compute);
     }
@@ -62,66 +54,79 @@ public:
     {
         glUseProgram(ID);
     }
+    // location of a uniform, from the table built at link time
+    // ------------------------------------------------------------------------
+    GLint uniform(std::string_view name) const
+    {
+        return uniforms.location(name);
+    }
     // utility uniform functions
     // ------------------------------------------------------------------------
-    void setBool(const std::string &name, bool value) const
+    void setBool(std::string_view name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(uniform(name), (int)value);
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
+    void setInt(std::string_view name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(uniform(name), value);
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
+    void setUInt(std::string_view name, unsigned int value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1ui(uniform(name), value);
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string &name, const glm::vec2 &value) const
+    void setFloat(std::string_view name, float value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform1f(uniform(name), value);
     }
-    void setVec2(const std::string &name, float x, float y) const
+    // ------------------------------------------------------------------------
+    void setVec2(std::string_view name, const glm::vec2 &value) const
+    {
+        glUniform2fv(uniform(name), 1, &value[0]);
+    }
+    void setVec2(std::string_view name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        glUniform2f(uniform(name), x, y);
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string &name, const glm::vec3 &value) const
+    void setVec3(std::string_view name, const glm::vec3 &value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform3fv(uniform(name), 1, &value[0]);
     }
-    void setVec3(const std::string &name, float x, float y, float z) const
+    void setVec3(std::string_view name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        glUniform3f(uniform(name), x, y, z);
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string &name, const glm::vec4 &value) const
+    void setVec4(std::string_view name, const glm::vec4 &value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform4fv(uniform(name), 1, &value[0]);
     }
-    void setVec4(const std::string &name, float x, float y, float z, float w)
+    void setVec4(std::string_view name, float x, float y, float z, float w)
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        glUniform4f(uniform(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string &name, const glm::mat2 &mat) const
+    void setMat2(std::string_view name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(uniform(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string &name, const glm::mat3 &mat) const
+    void setMat3(std::string_view name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(uniform(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string &name, const glm::mat4 &mat) const
+    void setMat4(std::string_view name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(uniform(name), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    UniformTable uniforms;
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
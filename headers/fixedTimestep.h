@@ -0,0 +1,32 @@
+#ifndef FIXED_TIMESTEP_CLASS_H
+#define FIXED_TIMESTEP_CLASS_H
+
+// Turns variable frame times into a whole number of fixed simulation steps.
+// Leftover time carries over to the next frame, and alpha() says how far the
+// frame sits between the last two steps so rendering can interpolate.
+class FixedTimestep
+{
+public:
+    // Seconds per simulation step
+    float step;
+    // Steps beyond this in one frame are dropped, so a hitch can't snowball
+    int maxStepsPerFrame;
+
+    // Simulation steps taken since the last reset
+    long long totalSteps = 0;
+
+    FixedTimestep(float step = 1.0f / 120.0f, int maxStepsPerFrame = 8);
+
+    // Adds the frame time and returns how many steps to run this frame
+    int advance(float frameDt);
+
+    // 0 renders the state before the last step, 1 the state after it
+    float alpha() const;
+
+    void reset();
+
+private:
+    double accumulator = 0.0;
+};
+
+#endif // !FIXED_TIMESTEP_CLASS_H
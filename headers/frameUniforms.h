@@ -0,0 +1,43 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+// Per-frame data every particle shader shares, one std140 uniform block
+// written once a frame instead of a set of uniforms per program per draw.
+// Included by both the C++ side and the shaders (through
+// res/shaders/common/frame.glsl), like particleLayout.h. Each vec3 is
+// followed by a float so C++ packs it the way std140 does.
+
+#define FRAME_UNIFORMS_BINDING 0
+
+#ifdef __cplusplus
+#include <glm/glm.hpp>
+
+namespace gpu
+{
+    typedef glm::mat4 mat4;
+    typedef glm::vec3 vec3;
+
+    struct FrameUniforms
+#else
+layout(std140, binding = FRAME_UNIFORMS_BINDING) uniform FrameUniforms
+#endif
+    {
+        mat4 camMatrix;  // projection * view
+        mat4 view;
+        mat4 projection;
+        vec3 camPos;
+        float alpha;     // Fraction of a step between prevPos and pos
+        vec3 sunDirection;
+        float framePad0;
+        vec3 color;      // Particle colour
+        float framePad1;
+        vec3 ambient;
+        float framePad2;
+    };
+
+#ifdef __cplusplus
+    static_assert(sizeof(FrameUniforms) == 256, "FrameUniforms must match std140");
+}
+#endif
+
+#endif // FRAME_UNIFORMS_H
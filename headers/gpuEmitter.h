@@ -0,0 +1,50 @@
+#ifndef GPU_EMITTER_CLASS_H
+#define GPU_EMITTER_CLASS_H
+
+#include "computeShader.h"
+#include "gpuParticlePool.h"
+
+enum class EmitterShape
+{
+    Point,
+    Sphere,
+    Disc
+};
+
+// Emits particles straight into the pool on the GPU (particleEmit.comp), at
+// rate particles per second. Each one gets a lifetime, and the pool's life
+// pass hands its slot back once it expires, so a steady emitter settles at
+// about rate * lifetime particles instead of growing forever.
+class GpuEmitter
+{
+public:
+    bool enabled = false;
+    EmitterShape shape = EmitterShape::Point;
+    glm::vec3 position = glm::vec3(0.0f, 10.0f, 0.0f);
+    float size = 1.0f;                          // Sphere or disc radius
+    glm::vec3 axis = glm::vec3(0.0f, 1.0f, 0.0f); // Disc normal
+    glm::vec3 velocity = glm::vec3(0.0f);
+    float velocitySpread = 0.0f; // Random velocity, uniform in a ball of this radius
+    float radialSpeed = 0.0f;    // Speed away from the centre
+    float lifetime = 5.0f;       // Seconds
+    float lifetimeSpread = 0.0f; // Lifetimes are uniform in lifetime +- this
+    float rate = 100.0f;         // Particles per second
+    float particleRadius = 0.5f;
+
+    GpuEmitter();
+
+    // Emits this step's share of rate. Call after pool.updateLifetimes() so the
+    // free list is fresh, and before the hash is built.
+    void emit(GpuParticlePool &pool, float dt);
+
+    void Delete();
+
+private:
+    ComputeShader emitShader;
+
+    float accumulator = 0.0f; // Fractional particles carried to the next step
+    unsigned int seed = 0;
+    int reserved = 0; // Pool slots already reserved for this emitter
+};
+
+#endif // !GPU_EMITTER_CLASS_H
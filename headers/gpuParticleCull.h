@@ -0,0 +1,67 @@
+#ifndef GPU_PARTICLE_CULL_CLASS_H
+#define GPU_PARTICLE_CULL_CLASS_H
+
+#include "computeShader.h"
+#include "gpuParticlePool.h"
+
+// Frustum and occlusion culling for the GPU mesh paths. cull() tests every
+// live particle's sphere (common/cull.glsl) and compacts the visible slots
+// into a list drawn by one indirect draw, so hidden particles cost neither
+// vertex work nor a readback. GpuParticleLod runs the same test while it
+// buckets, after prepare().
+//
+// Occlusion is tested against a max-depth pyramid of the previous frame's
+// depth buffer, rebuilt by updateHiZ() once the particles are drawn. A
+// particle that comes out from behind an occluder can therefore show a frame
+// late; the pyramid is only trusted when it was built the frame before, so
+// beginFrame() must be called every frame, culled or not.
+//
+// Bindings: 24 cull stats, 25 draw command, 26 visible slot list.
+class GpuParticleCull
+{
+public:
+    bool frustum = true;
+    bool occlusion = true;
+
+    GLuint commandBuffer; // One gpu::DrawCommand, its instanceCount the visible count
+    GLuint visibleBuffer; // Visible slots, read by particleCulled.vert
+    GLuint statsBuffer;   // gpu::CullStats of the last pass
+
+    GpuParticleCull();
+
+    // Starts a frame; a pyramid not rebuilt last frame goes stale
+    void beginFrame();
+
+    // Compacts the pool's visible particles, at the alpha they will be drawn at
+    void cull(GpuParticlePool &pool, const glm::mat4 &cameraMatrix, float alpha);
+
+    // Draws the visible list with the pool's mesh (setIndexCount), its VAO bound, and particleCulled.vert
+    void drawElements();
+
+    // Zeroes the stats and sets up the test for a shader that includes common/cull.glsl
+    void prepare(ComputeShader &shader, const glm::mat4 &cameraMatrix);
+
+    // Copies the bound framebuffer's depth and rebuilds the pyramid for next frame
+    void updateHiZ(int width, int height);
+
+    void Delete();
+
+private:
+    ComputeShader cullShader;
+    ComputeShader hiZShader;
+
+    GLuint depthTexture = 0; // GL_DEPTH_COMPONENT32F copy of the depth buffer
+    GLuint hiZTexture = 0;   // r32f max-depth pyramid
+    int hiZWidth = 0;
+    int hiZHeight = 0;
+    int hiZLevels = 0;
+    long long frame = 0;
+    long long hiZFrame = -1; // Frame the pyramid was last built on
+
+    int capacity = 0;
+
+    void reserve(int n);
+    void resizeHiZ(int width, int height);
+};
+
+#endif // !GPU_PARTICLE_CULL_CLASS_H
@@ -0,0 +1,58 @@
+#ifndef GPU_PARTICLE_LOD_CLASS_H
+#define GPU_PARTICLE_LOD_CLASS_H
+
+#include <vector>
+
+#include "computeShader.h"
+#include "gpuParticleCull.h"
+#include "gpuParticlePool.h"
+
+// Draws the pool's particles with icospheres of several subdivision levels,
+// picked per particle from its projected radius. particleLod.comp buckets the
+// live slots by level into one instance list per level and counts them into
+// one indirect command per level, so distant particles cost the 20 triangles
+// of a bare icosahedron and close ones get the finest sphere, all without a
+// readback. The levels share one vertex and index buffer.
+//
+// Bindings: 22 draw commands, 23 per-level slot lists.
+class GpuParticleLod
+{
+public:
+    static const int levels = 4; // Subdivisions 0..3: 20, 80, 320 and 1280 triangles
+
+    // Projected radius in pixels above which each level takes over from the
+    // one below; level 0 covers everything smaller than lodPixels[0]
+    float lodPixels[levels - 1] = {4.0f, 12.0f, 48.0f};
+
+    GLuint commandBuffer;  // levels gpu::DrawCommands
+    GLuint instanceBuffer; // Slot lists, level l starts at l * capacity
+
+    GpuParticleLod();
+
+    // Buckets the pool's live particles by level, at the alpha they will be
+    // drawn at. pixelScale turns a radius over view depth into pixels:
+    // projection[1][1] * viewport height / 2. Given a cull, particles it
+    // rejects are left out.
+    void bucket(GpuParticlePool &pool, const glm::mat4 &cameraMatrix, float pixelScale, float alpha, GpuParticleCull *cull = nullptr);
+
+    // One indirect draw per level, with particleLod.vert
+    void draw();
+
+    // Triangles of each level, for the stats panel
+    int triangleCount(int level) const { return levelIndexCounts[level] / 3; }
+
+    void Delete();
+
+private:
+    ComputeShader lodShader;
+
+    GLuint VAO, VBO, EBO;
+    int capacity = 0; // Slots per level list
+    GLuint levelIndexCounts[levels];
+    GLuint levelFirstIndex[levels];
+    GLint levelBaseVertex[levels];
+
+    void reserve(int n);
+};
+
+#endif // !GPU_PARTICLE_LOD_CLASS_H
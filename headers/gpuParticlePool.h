@@ -0,0 +1,92 @@
+#ifndef GPU_PARTICLE_POOL_CLASS_H
+#define GPU_PARTICLE_POOL_CLASS_H
+
+#include "computeShader.h"
+#include "particleLayout.h"
+
+// GPU particles, see particleLayout.h. The live count exists only on the GPU
+// (counters at binding 12), and every pass over the particles is launched
+// with glDispatchComputeIndirect / glDrawElementsIndirect from arguments the
+// args pass derives from it. Nothing reads the count back, so GPU passes can
+// add and remove particles without a CPU round trip.
+//
+// Particles die when their lifetime runs out; their slots go on a free list
+// that new particles are taken from first, see particleLife.comp. The list
+// holds from the life pass until a sort moves the particles, which empties
+// it. The solver keeps a second list of the slots that are awake, see
+// particleSleep.comp, and passes that only move particles go over it with
+// dispatchActive().
+//
+// Bindings: 0 particles, 10 render stream, 6 spawn indices (particleIds.glsl),
+// 12 counters, 16 lifetimes, 18 free list, 21 active list. Everything grows by doubling with
+// the used slots copied GPU to GPU.
+class GpuParticlePool
+{
+public:
+    GLuint buffer;
+    GLuint renderBuffer;
+    GLuint idsBuffer;
+    GLuint lifeBuffer;
+    GLuint freeBuffer;
+    GLuint activeBuffer;
+    GLuint counterBuffer;
+    GLuint argsBuffer;
+
+    // Upper bound on the GPU's slotCount, what the CPU sizes buffers by
+    int count = 0;
+    int capacity = 0;
+
+    GpuParticlePool(int initialCapacity = 512);
+
+    // Makes room for n particles, keeping the first count
+    void reserve(int n);
+
+    // Queues n particles for the append pass, which gives them slots on the GPU
+    void append(const gpu::Particle *particles, const gpu::ParticleRender *renders, int n);
+
+    // Raises the upper bound by n slots that GPU passes (emitters) may take
+    void reserveSlots(int n);
+
+    // Ages particles by dt, kills expired ones and rebuilds the free list
+    void updateLifetimes(float dt);
+
+    // Rewrites the indirect arguments from the live count, after any pass that changes it
+    void updateArgs();
+
+    // Index count of the mesh every particle is drawn with
+    void setIndexCount(GLuint indexCount);
+
+    // One invocation per used slot, localSize is the shader's local_size_x (128 or 256)
+    void dispatch(int localSize);
+
+    // One invocation per entry on the active list, as of the last updateArgs()
+    void dispatchActive(int localSize);
+
+    // One instance per used slot, with the mesh's VAO bound. Dead ones are culled in the vertex shader.
+    void drawElements();
+
+    // Same instances, each vertexCount vertices with no mesh, for shaders that
+    // make their own geometry from gl_VertexID (particleImpostor.vert)
+    void drawArrays(GLenum mode, GLuint vertexCount);
+
+    void clear();
+
+    void Delete();
+
+private:
+    ComputeShader appendShader;
+    ComputeShader argsShader;
+    ComputeShader lifeShader;
+
+    GLuint stagedBuffer;
+    GLuint stagedRenderBuffer;
+    int stagedCapacity = 0;
+
+    // DrawArraysIndirectCommand for drawArrays(), its instanceCount copied from argsBuffer on the GPU
+    GLuint arraysArgsBuffer;
+};
+
+// Reallocates buffer to newSize bytes, copying its first keepSize on the GPU
+void growShaderBuffer(GLuint &buffer, GLsizeiptr keepSize, GLsizeiptr newSize);
+
+#endif // !GPU_PARTICLE_POOL_CLASS_H
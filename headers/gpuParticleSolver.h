@@ -0,0 +1,79 @@
+#ifndef GPU_PARTICLE_SOLVER_CLASS_H
+#define GPU_PARTICLE_SOLVER_CLASS_H
+
+#include "computeShader.h"
+#include "gpuParticlePool.h"
+#include "gpuParticleSort.h"
+#include "gpuSpatialHash.h"
+
+enum class SolverMode
+{
+    Direct,  // particle.comp: both particles of a contact written in place, fastest but racy
+    Jacobi,  // particleJacobi.comp: neighbours read from a snapshot, own particle written
+    Coloured, // particleColoured.comp: Gauss-Seidel over 27 cell colours, as Physx does on the CPU
+    Xpbd      // Coloured passes with XPBD position constraints, as ContactModel::Xpbd on the CPU
+};
+
+// Steps the pool's particles on the GPU in subSteps substeps, each with a
+// hash of where the particles are now. Jacobi, Coloured and Xpbd never have
+// two invocations write one particle, and sort the hash buckets, so a run
+// repeats bit for bit from the same pool.
+//
+// Every step starts with the sleep pass (particleSleep.comp), which lists
+// the awake particles; the passes that move particles only go over that
+// list, and sleeping particles are static to the contacts, as on the CPU
+// (see Physx::sleeping).
+class GpuParticleSolver
+{
+public:
+    SolverMode mode = SolverMode::Direct;
+    int subSteps = 4;
+    int substepsPerHash = 1; // Direct only, substeps run in one dispatch against the same hash
+    int iterations = 1;      // Jacobi, Coloured and Xpbd, contact passes per substep
+    float relaxation = 1.5f; // Jacobi only, scales the summed contact corrections
+    float compliance = 0.0f; // Xpbd only, inverse contact stiffness, 0 is rigid
+    float damping = 0.0f;    // Xpbd only
+    bool sleeping = false;
+    float sleepSpeed = 0.1f;  // Averaged over a step
+    float sleepTime = 0.5f;   // Rounded to whole steps, at most PARTICLE_REST_MAX
+    float wakeEnergy = 0.05f; // Relative kinetic energy (unit masses) a contact needs to wake a particle
+    float gravity = 9.81f;
+    float containerRadius = 3.35f;
+    float particleRadius = 0.1f;
+
+    GpuParticleSolver();
+
+    // Advances the pool by dt. sort, when given, reorders the pool by hash
+    // bucket before anything moves.
+    void step(GpuParticlePool &pool, GpuSpatialHash &hash, float dt, GpuParticleSort *sort = nullptr);
+
+    void Delete();
+
+private:
+    ComputeShader directShader;
+    ComputeShader integrateShader;
+    ComputeShader jacobiShader;
+    ComputeShader colouredShader;
+    ComputeShader xpbdVelocityShader;
+    ComputeShader sleepShader;
+
+    // Copy of the particles at binding 19: what Jacobi reads neighbours from,
+    // what Coloured takes cells from
+    GLuint snapshotBuffer;
+    int snapshotCapacity = 0;
+
+    // Substep start positions at binding 20, Xpbd only
+    GLuint startBuffer;
+    int startCapacity = 0;
+
+    // Steps at rest before a particle sleeps this step, 0 when sleeping is off
+    GLuint sleepSteps = 0;
+
+    void setUniforms(ComputeShader &shader, GpuSpatialHash &hash, float subDt, int subStep);
+    void updateSleep(GpuParticlePool &pool, float dt);
+    void stepDirect(GpuParticlePool &pool, GpuSpatialHash &hash, float dt, bool hashBuilt);
+    void stepRaceFree(GpuParticlePool &pool, GpuSpatialHash &hash, float dt);
+    void takeSnapshot(GpuParticlePool &pool);
+};
+
+#endif // !GPU_PARTICLE_SOLVER_CLASS_H
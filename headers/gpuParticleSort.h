@@ -0,0 +1,33 @@
+#ifndef GPU_PARTICLE_SORT_CLASS_H
+#define GPU_PARTICLE_SORT_CLASS_H
+
+#include "computeShader.h"
+#include "gpuParticlePool.h"
+
+// Reorders the particle pool by hash bucket so the neighbour loops in
+// particle.comp read contiguous memory. Lifetimes and spawn indices move
+// along, and dead slots collect at the back.
+class GpuParticleSort
+{
+public:
+    GpuParticleSort();
+
+    // Sorts the pool's live particles, the hash must have just been built from
+    // them. The sorted copies go to scratch buffers that are swapped in, so
+    // the pool's buffers change names. Empties the free list, whose slots the
+    // sort has moved.
+    void sort(GpuParticlePool &pool);
+
+    void Delete();
+
+private:
+    ComputeShader sortShader;
+
+    GLuint sortedBuffer;
+    GLuint sortedRenderBuffer;
+    GLuint sortedIdsBuffer;
+    GLuint sortedLifeBuffer;
+    int sortedCapacity = 0;
+};
+
+#endif // !GPU_PARTICLE_SORT_CLASS_H
@@ -0,0 +1,34 @@
+#ifndef GPU_PREFIX_SUM_CLASS_H
+#define GPU_PREFIX_SUM_CLASS_H
+
+#include <vector>
+
+#include "computeShader.h"
+
+// Multi-level inclusive prefix sum over an int SSBO. Each level scans blocks
+// of 1024 values in one workgroup, the block totals are scanned by the next
+// level and added back, so any count fits in a handful of dispatches.
+class GpuPrefixSum
+{
+public:
+    GpuPrefixSum();
+
+    // Replaces the first count ints of buffer with their inclusive prefix sum
+    void scan(GLuint buffer, int count);
+
+    void Delete();
+
+private:
+    static const int blockSize = 1024;
+
+    ComputeShader scanShader;
+    ComputeShader addShader;
+
+    // Block totals of every level, grown on demand
+    std::vector<GLuint> levelBuffers;
+    std::vector<int> levelCapacity;
+
+    void scanLevel(GLuint buffer, int count, size_t level);
+};
+
+#endif // !GPU_PREFIX_SUM_CLASS_H
@@ -0,0 +1,86 @@
+#ifndef GPU_PROFILER_CLASS_H
+#define GPU_PROFILER_CLASS_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include "profiler.h"
+
+// GPU zones for the Profiler timeline. Every zone is a pair of GL_TIMESTAMP
+// queries (glQueryCounter) rather than a GL_TIME_ELAPSED query, since elapsed
+// queries can't nest. Results are read a few frames late, once available, so
+// nothing stalls; a GL_TIMESTAMP read at the start of every frame maps the
+// GPU clock onto the CPU one so both lanes share a time axis and the GPU's
+// lag behind the CPU shows up as it is.
+class GpuProfiler
+{
+public:
+    GpuProfiler(int framesInFlight = 4);
+
+    // Call after profiler.beginFrame(), zones go to the frame it started
+    void beginFrame(Profiler &profiler);
+    void endFrame();
+
+    // Returns the zone's index for endZone, -1 if the profiler isn't recording
+    int beginZone(const char *name);
+    void endZone(int zone);
+
+    // Hands the zones of every frame whose queries have finished to profiler, never waits
+    void collect(Profiler &profiler);
+
+    void Delete();
+
+private:
+    struct Zone
+    {
+        const char *name;
+        int depth;
+        GLuint startQuery;
+        GLuint endQuery;
+    };
+
+    struct Frame
+    {
+        long long frame = -1;
+        double syncMs = 0.0;      // Profiler clock when gpuSyncNs was read, relative to the frame start
+        GLint64 gpuSyncNs = 0;
+        std::vector<Zone> zones;
+        std::vector<GLuint> queries; // Grows as needed, reused every time the slot comes round
+        int usedQueries = 0;
+        bool pending = false;
+    };
+
+    std::vector<Frame> frames;
+    int current = -1; // Frame being recorded, -1 outside a recorded frame
+    int next = 0;
+    int depth = 0;
+
+    GLuint acquireQuery(Frame &f);
+    // Reads f's results into profiler, returns false if they aren't ready and wait is false
+    bool resolve(Frame &f, Profiler &profiler, bool wait);
+};
+
+// Records the enclosing scope as a GPU zone
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(GpuProfiler &profiler, const char *name)
+        : profiler(profiler), zone(profiler.beginZone(name))
+    {
+    }
+
+    ~GpuProfileScope()
+    {
+        profiler.endZone(zone);
+    }
+
+    GpuProfileScope(const GpuProfileScope &) = delete;
+    GpuProfileScope &operator=(const GpuProfileScope &) = delete;
+
+private:
+    GpuProfiler &profiler;
+    int zone;
+};
+
+#endif // !GPU_PROFILER_CLASS_H
@@ -0,0 +1,48 @@
+#ifndef GPU_SPATIAL_HASH_CLASS_H
+#define GPU_SPATIAL_HASH_CLASS_H
+
+#include "computeShader.h"
+#include "gpuParticlePool.h"
+#include "gpuPrefixSum.h"
+
+// Builds the spatial hash particle.comp queries, entirely on the GPU:
+// clear, count per bucket, prefix sum, scatter. The table lives in the SSBOs
+// at bindings 1 (cellStart), 2 (particleMap) and 3 (cellIds), see hash.glsl.
+class GpuSpatialHash
+{
+public:
+    float spacing;
+    int maxNumObjs = 0;
+    int tableSize = 0;
+
+    GLuint cellCountBuffer;
+    GLuint particleMapBuffer;
+    GLuint cellIdsBuffer;
+
+    GpuSpatialHash(float spacing);
+
+    // Grows the buffers to hold numObjs particles and (re)binds them
+    void resize(int numObjs);
+
+    // Rebuilds the table from the pool's live particles. The table is sized
+    // by the pool's capacity, the live count is only known to the GPU.
+    void build(GpuParticlePool &pool);
+
+    // Sorts every bucket by particle index, so queries visit neighbours in
+    // the same order every run. Call after build().
+    void sortBuckets();
+
+    // Sets the hash.* uniforms of a shader that includes hash.glsl
+    void setUniforms(ComputeShader &shader);
+
+    void Delete();
+
+private:
+    ComputeShader clearShader;
+    ComputeShader countShader;
+    ComputeShader scatterShader;
+    ComputeShader sortBucketsShader;
+    GpuPrefixSum prefixSum;
+};
+
+#endif // !GPU_SPATIAL_HASH_CLASS_H
@@ -0,0 +1,66 @@
+#ifndef JOB_SYSTEM_CLASS_H
+#define JOB_SYSTEM_CLASS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool with one deque per thread: owners pop from the back, idle
+// threads steal from the front of the others. The calling thread takes part
+// in the work, so a pool of 1 thread runs everything inline.
+class JobSystem
+{
+public:
+    // 0 uses every hardware thread
+    JobSystem(int numThreads = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    int threadCount() const { return (int)queues.size(); }
+    void setThreadCount(int numThreads);
+
+    // Calls f(begin, end) on chunks of at most grain items covering [0, count)
+    // and returns once every chunk has finished
+    void parallelFor(int count, int grain, const std::function<void(int, int)> &f);
+
+private:
+    struct Job
+    {
+        const std::function<void(int, int)> *f;
+        int begin;
+        int end;
+        std::atomic<int> *pending;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    // Queue 0 belongs to the thread calling parallelFor, the rest to the workers
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queued{0};
+    bool running = false;
+
+    void start(int numThreads);
+    void stop();
+
+    void workerLoop(int index);
+    bool popLocal(int index, Job &job);
+    bool steal(int index, Job &job);
+    void run(Job &job);
+};
+
+#endif // !JOB_SYSTEM_CLASS_H
@@ -23,6 +23,9 @@ public:
     std::vector<GLuint> indices;
     std::vector<Texture> textures;
     VAO VAO;
+    // Kept so other VAOs (e.g. instanced ones) can reuse the uploaded data
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
 
     Mesh(std::vector<Vertex> &vertices, std::vector<GLuint> &indices, std::vector<Texture> &textures);
 
@@ -0,0 +1,24 @@
+#ifndef MESH_REGISTRY_CLASS_H
+#define MESH_REGISTRY_CLASS_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "model.h"
+
+// Loads every model file once, everything drawing the same file shares its
+// meshes (and their GPU buffers) instead of parsing and uploading its own copy
+class MeshRegistry
+{
+public:
+    static Model &Get(const std::string &file);
+    static Mesh &GetMesh(const std::string &file, unsigned int index = 0);
+
+    static void Clear();
+
+private:
+    static std::unordered_map<std::string, std::unique_ptr<Model>> models;
+};
+
+#endif // !MESH_REGISTRY_CLASS_H
@@ -0,0 +1,190 @@
+#ifndef PARTICLE_LAYOUT_H
+#define PARTICLE_LAYOUT_H
+
+// GPU particle format, included by both the C++ side and the shaders (through
+// res/shaders/common/particles.glsl) so the two can never disagree. Only
+// plain structs of vec4/float/uint go here, they read the same in both. A
+// vec3 is fine when a 4-byte scalar follows it, std430 packs the two into 16.
+//
+// Per particle, compared with the old four alignas(16) vec3 record:
+//
+//   layout              solver stream   render stream   total
+//   old Obj             64 B            -               64 B
+//   ParticleFull        32 B            16 B            48 B
+//   ParticleHalf        24 B            16 B            40 B
+//
+// The solver reads the solver stream of every neighbour it tests, so its
+// traffic halves with ParticleFull. prevPos is only read by the vertex
+// shader and lives in its own buffer, out of the neighbour loops' way.
+
+// Uncomment to store velocity and radius as halves (packHalf2x16). Positions
+// stay 32-bit floats, half precision is too coarse for contacts.
+// #define PARTICLE_LAYOUT_HALF
+
+#define PARTICLE_FLAG_ALIVE 1u
+// Steps spent at rest, bits 8..15 of the flags, see particleSleep.comp
+#define PARTICLE_REST_SHIFT 8u
+#define PARTICLE_REST_MAX 255u
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace gpu
+{
+    typedef glm::vec3 vec3;
+    typedef glm::vec4 vec4;
+    typedef std::uint32_t uint;
+#endif
+
+    // xyz position and radius, velocity and flags. The flags are a real uint,
+    // not bits in a float channel a driver might flush as a denormal
+    struct ParticleFull
+    {
+        vec4 posRadius;
+        vec3 vel;
+        uint flags;
+    };
+
+    // Float position, half velocity and radius, tightly packed (no vec4 so
+    // std430 doesn't pad the array stride to 32)
+    struct ParticleHalf
+    {
+        float px;
+        float py;
+        float pz;
+        uint flags;
+        uint velXY;      // packHalf2x16(vel.x, vel.y)
+        uint velZRadius; // packHalf2x16(vel.z, radius)
+    };
+
+    // Render-only stream, written at the start of a step for interpolation
+    struct ParticleRender
+    {
+        vec4 prevPos;
+    };
+
+    // Particle counts, owned by the GPU. Slots [0, slotCount) have been handed
+    // out and may hold dead particles (PARTICLE_FLAG_ALIVE clear) waiting on
+    // the free list. Appends and emitters reserve slots with atomicAdd, which
+    // may overshoot capacity; the args pass clamps it back.
+    struct ParticleCounters
+    {
+        uint slotCount;
+        uint spawnedCount; // Spawn indices handed out so far, never reused
+        uint capacity;     // Slots allocated, written by the CPU when the pool grows
+        int freeCount;     // Entries on the free list, rebuilt every step by the life pass, zeroed by a sort
+        uint aliveCount;   // Counted by the life pass, for stats
+        uint activeCount;  // Awake particles on the active list, rebuilt every step by the sleep pass
+        uint pad1;
+        uint pad2;
+    };
+
+    // glDispatchComputeIndirect and glDrawElementsIndirect arguments, written
+    // from slotCount by particleArgs.comp so nothing has to read it back
+    struct IndirectArgs
+    {
+        uint particleGroups[3]; // local_size_x = 128 passes over the slots (particle.comp)
+        uint bufferGroups[3];   // local_size_x = 256 passes over the slots (hash, sort, life)
+        uint indexCount;        // DrawElementsIndirectCommand from here on
+        uint instanceCount;
+        uint firstIndex;
+        int baseVertex;
+        uint baseInstance;
+        uint activeParticleGroups[3]; // As particleGroups and bufferGroups, over the active list
+        uint activeBufferGroups[3];
+    };
+
+    // glDrawElementsIndirect / glMultiDrawElementsIndirect command, for draws
+    // whose instance counts a compute pass fills in (particleLod.comp)
+    struct DrawCommand
+    {
+        uint count;
+        uint instanceCount;
+        uint firstIndex;
+        int baseVertex;
+        uint baseInstance;
+    };
+
+    // Particles the visibility test (common/cull.glsl) rejected, per test
+    struct CullStats
+    {
+        uint frustumCulled;
+        uint occlusionCulled;
+    };
+
+#ifdef __cplusplus
+#ifdef PARTICLE_LAYOUT_HALF
+    typedef ParticleHalf Particle;
+#else
+    typedef ParticleFull Particle;
+#endif
+
+    static_assert(sizeof(ParticleFull) == 32, "ParticleFull must match std430");
+    static_assert(offsetof(ParticleFull, flags) == 28, "ParticleFull must match std430");
+    static_assert(sizeof(ParticleHalf) == 24, "ParticleHalf must match std430");
+    static_assert(sizeof(ParticleRender) == 16, "ParticleRender must match std430");
+    static_assert(sizeof(ParticleCounters) == 32, "ParticleCounters must match std430");
+    static_assert(sizeof(IndirectArgs) == 68, "IndirectArgs must match std430");
+    static_assert(sizeof(DrawCommand) == 20, "DrawCommand must match std430");
+    static_assert(sizeof(CullStats) == 8, "CullStats must match std430");
+
+    inline ParticleFull packParticle(const glm::vec3 &pos, const glm::vec3 &vel, float radius, uint flags, ParticleFull)
+    {
+        return {glm::vec4(pos, radius), vel, flags};
+    }
+
+    inline ParticleHalf packParticle(const glm::vec3 &pos, const glm::vec3 &vel, float radius, uint flags, ParticleHalf)
+    {
+        return {pos.x, pos.y, pos.z, flags,
+                glm::packHalf2x16(glm::vec2(vel.x, vel.y)),
+                glm::packHalf2x16(glm::vec2(vel.z, radius))};
+    }
+
+    // Packs into whichever layout PARTICLE_LAYOUT_HALF selects
+    inline Particle packParticle(const glm::vec3 &pos, const glm::vec3 &vel, float radius, uint flags = PARTICLE_FLAG_ALIVE)
+    {
+        return packParticle(pos, vel, radius, flags, Particle());
+    }
+
+    inline glm::vec3 particlePosition(const ParticleFull &p)
+    {
+        return glm::vec3(p.posRadius.x, p.posRadius.y, p.posRadius.z);
+    }
+
+    inline glm::vec3 particlePosition(const ParticleHalf &p)
+    {
+        return glm::vec3(p.px, p.py, p.pz);
+    }
+
+    inline uint particleFlags(const ParticleFull &p)
+    {
+        return p.flags;
+    }
+
+    inline uint particleFlags(const ParticleHalf &p)
+    {
+        return p.flags;
+    }
+
+    inline glm::vec3 particleVelocity(const ParticleFull &p)
+    {
+        return p.vel;
+    }
+
+    inline glm::vec3 particleVelocity(const ParticleHalf &p)
+    {
+        glm::vec2 velXY = glm::unpackHalf2x16(p.velXY);
+        return glm::vec3(velXY.x, velXY.y, glm::unpackHalf2x16(p.velZRadius).x);
+    }
+}
+#else
+#ifdef PARTICLE_LAYOUT_HALF
+#define Particle ParticleHalf
+#else
+#define Particle ParticleFull
+#endif
+#endif
+
+#endif // !PARTICLE_LAYOUT_H
@@ -0,0 +1,44 @@
+#ifndef PARTICLE_RENDERER_CLASS_H
+#define PARTICLE_RENDERER_CLASS_H
+
+#include "mesh.h"
+#include "particleSystem.h"
+
+// Draws a ParticleSystem as instances of one mesh, the SoA arrays are
+// uploaded as-is and read as separate per-instance attribute streams
+class ParticleRenderer
+{
+public:
+    // Location of the optional per-instance colour in particleInstancedColor.vert
+    static const GLuint colorLocation = 10;
+
+    ParticleRenderer(Mesh &mesh);
+
+    // colors, one per particle, is streamed to colorLocation for shaders that
+    // read it; leave it out for shaders that don't. The camera comes from the
+    // frame uniform block (frameUniforms.h).
+    void Draw(ParticleSystem &ps, Shader &shader, const std::vector<glm::vec3> *colors = nullptr);
+
+    // One camera-facing quad per particle for particleImpostorInstanced.vert
+    // and particleImpostor.frag to ray-trace a sphere into
+    void DrawImpostors(ParticleSystem &ps, Shader &shader);
+
+    void Delete();
+
+private:
+    // Instance attribute streams, starting at location 3
+    static const GLuint numStreams = 7;
+
+    GLuint VAO, instanceVBO, colorVBO;
+    GLsizei indexCount;
+    size_t capacity = 0;
+    size_t colorCapacity = 0;
+
+    // Grows the instance buffer and points the attributes at the new array offsets
+    void reserve(size_t count);
+
+    // Streams the particles, and colors if given, into the instance buffers
+    void upload(ParticleSystem &ps, const std::vector<glm::vec3> *colors);
+};
+
+#endif // !PARTICLE_RENDERER_CLASS_H
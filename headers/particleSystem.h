@@ -0,0 +1,64 @@
+#ifndef PARTICLE_SYSTEM_CLASS_H
+#define PARTICLE_SYSTEM_CLASS_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Stays valid while the particle lives, even when swap-removes move it around
+struct ParticleHandle
+{
+    uint32_t slot;
+    uint32_t generation;
+};
+
+// Structure-of-arrays particle store, every component is contiguous and
+// indexed 0..size()-1 so the solver loops stream straight through memory
+class ParticleSystem
+{
+public:
+    std::vector<float> x, y, z;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> ax, ay, az;
+    std::vector<float> radius;
+    // Positions before the latest step, for render interpolation
+    std::vector<float> px, py, pz;
+    // Seconds spent at rest, Physx puts particles to sleep once it passes sleepTime
+    std::vector<float> sleepTimer;
+
+    ParticleHandle spawn(glm::vec3 pos, glm::vec3 vel, float r);
+    // Moves the last particle into the hole, so dense indices are not stable
+    void remove(ParticleHandle handle);
+    void clear();
+    void reserve(size_t count);
+
+    bool alive(ParticleHandle handle) const;
+    int indexOf(ParticleHandle handle) const;
+    size_t size() const { return x.size(); }
+
+    glm::vec3 position(int i) const { return glm::vec3(x[i], y[i], z[i]); }
+    glm::vec3 velocity(int i) const { return glm::vec3(vx[i], vy[i], vz[i]); }
+
+    // Velocity Verlet with gravity and friction, over [begin, end) or every particle
+    void integrate(float dt, float g, int begin, int end);
+    void integrate(float dt, float g) { integrate(dt, g, 0, (int)size()); }
+    // Keeps particles inside a sphere of radius r around the origin
+    void constraint(float r, int begin, int end);
+    void constraint(float r) { constraint(r, 0, (int)size()); }
+
+private:
+    std::vector<uint32_t> slotToIndex;
+    std::vector<uint32_t> slotGeneration;
+    std::vector<uint32_t> indexToSlot;
+    std::vector<uint32_t> freeSlots;
+
+    template <typename F>
+    void forEachArray(F f)
+    {
+        std::vector<float> *arrays[] = {&x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az, &radius, &px, &py, &pz, &sleepTimer};
+        for (std::vector<float> *a : arrays)
+            f(*a);
+    }
+};
+
+#endif // !PARTICLE_SYSTEM_CLASS_H
@@ -1,14 +1,81 @@
 #ifndef PHYSX
 #define PHYSX
 
-#include "particle.h"
+#include "jobSystem.h"
+#include "particleSystem.h"
+#include "spatialHash.h"
+
+#include <cstdint>
+#include <functional>
+
+// How Physx resolves a contact
+enum class ContactModel
+{
+    Impulse, // Push both apart by half the overlap, then a restitution impulse
+    Xpbd     // Compliant position constraint, velocities from how far particles moved
+};
 
 class Physx
 {
 public:
-    void update(float pr, float dt, float g, float r);
+    ContactModel contactModel = ContactModel::Impulse;
+    float compliance = 0.0f; // Xpbd only, inverse contact stiffness (unit masses), 0 is rigid
+    float damping = 0.0f;    // Xpbd only, damps compliant contacts, no effect when rigid
+
+    // A particle that moves slower than sleepSpeed (averaged over a step) for
+    // sleepTime seconds falls asleep: it isn't integrated and awake particles
+    // treat it as static. A contact involving a moving particle with more
+    // relative kinetic energy than wakeEnergy (unit masses) wakes it and
+    // restarts both timers, so a pile only sleeps once all of it rests.
+    bool sleeping = false;
+    float sleepSpeed = 0.1f;
+    float sleepTime = 0.5f;
+    float wakeEnergy = 0.05f;
+
+    // 0 uses every hardware thread
+    Physx(int numThreads = 0) : jobs(numThreads) {}
+
+    // Advances dt in subSteps substeps, each integrating dt / subSteps and
+    // rebuilding the hash before resolving contacts
+    void update(ParticleSystem &ps, float pr, float dt, float g, float r, int subSteps = 1);
+
+    int threadCount() const { return jobs.threadCount(); }
+    void setThreadCount(int numThreads) { jobs.setThreadCount(numThreads); }
+
+    // Particles the last substep integrated
+    int awakeCount() const { return (int)active.size(); }
 
 private:
+    JobSystem jobs;
+    SpatialHash hash = SpatialHash(0.2f, 512);
+
+    // Grid cell every particle was hashed into this step
+    std::vector<int> cellX, cellY, cellZ;
+    // Non-empty buckets per cell colour, see update()
+    std::vector<int> colourBuckets[27];
+
+    // Per thread buffers for the narrowphase
+    struct ContactScratch
+    {
+        std::vector<int> queryIds;
+        std::vector<int> candidates;
+        std::vector<int> hits;
+    };
+
+    // Positions at the start of the substep, Xpbd only
+    std::vector<float> startX, startY, startZ;
+
+    // Particles awake at the start of the substep, as a list and as flags
+    std::vector<int> active;
+    std::vector<uint8_t> awake;
+
+    void subStep(ParticleSystem &ps, float pr, float dt, float g, float r, bool first);
+    void updateSleep(ParticleSystem &ps, float dt);
+    bool asleep(const ParticleSystem &ps, int i) const { return sleeping && ps.sleepTimer[i] >= sleepTime; }
+    // Calls f(begin, end) in parallel on runs of consecutive awake particles
+    void forActiveRuns(const std::function<void(int, int)> &f);
+    int colourOf(int i) const;
+    void resolveBucket(ParticleSystem &ps, int bucket, int colour, float pr, float dt, ContactScratch &scratch);
 };
 
-#endif // !PHYSX
\ No newline at end of file
+#endif // !PHYSX
@@ -0,0 +1,116 @@
+#ifndef PROFILER_CLASS_H
+#define PROFILER_CLASS_H
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Where a zone ran. GPU zones come from GpuProfiler's timer queries and land
+// a few frames after the CPU zones of the same frame.
+enum class ProfileLane
+{
+    Cpu,
+    Gpu
+};
+
+struct ProfileZone
+{
+    const char *name; // Must outlive the profiler, string literals in practice
+    ProfileLane lane;
+    int depth;        // Nesting level within its lane, 0 is outermost
+    double startMs;   // Since the frame began on the CPU
+    double durationMs;
+};
+
+struct ProfileFrame
+{
+    long long frame = -1;
+    double startMs = 0.0; // Since the profiler was created
+    double durationMs = 0.0;
+    std::vector<ProfileZone> zones;
+};
+
+// Scoped CPU profiler. Zones nest and are recorded into the current frame,
+// and the last `capacity` frames are kept in a ring that reuses its zone
+// storage, so recording allocates nothing once warm. Only the thread that
+// calls beginFrame() records; zones opened on job threads or outside a frame
+// (the simulator, benchmarks) cost a branch and are dropped.
+class Profiler
+{
+public:
+    // Set false to stop recording, e.g. to inspect a hitch without it scrolling away
+    bool recording = true;
+
+    Profiler(int capacity = 240);
+
+    // The one the PROFILE_ZONE macro records into
+    static Profiler &Get();
+
+    void beginFrame();
+    void endFrame();
+
+    // Returns the zone's index for endZone, -1 if it isn't being recorded
+    int beginZone(const char *name);
+    void endZone(int zone);
+
+    // Adds a zone to an earlier frame, dropped if that frame left the ring
+    void addZone(long long frame, const ProfileZone &zone);
+
+    // Milliseconds since the profiler was created, the clock zones are measured on
+    double now() const;
+    long long currentFrame() const { return frameNumber; }
+    // now() when the current frame began
+    double frameStartMs() const { return frames[head].startMs; }
+
+    // Finished frames, 0 is the oldest still in the ring
+    int frameCount() const { return count; }
+    const ProfileFrame &frame(int i) const;
+
+    // Mean time per frame spent in the named zone, over those of the last `frames` frames that have it
+    double averageMs(const char *name, ProfileLane lane, int frames = 60) const;
+
+    // One row per zone: frame,lane,name,depth,start_ms,duration_ms
+    bool writeCsv(const std::string &filename) const;
+    // Chrome trace event format, opens in chrome://tracing and Perfetto
+    bool writeChromeTrace(const std::string &filename) const;
+
+private:
+    std::vector<ProfileFrame> frames;
+    int head = 0;  // Slot of the frame being recorded
+    int count = 0; // Finished frames in the ring
+    long long frameNumber = -1;
+    bool inFrame = false;
+    int depth = 0;
+    std::thread::id owner;
+    std::chrono::steady_clock::time_point origin;
+
+    ProfileFrame *find(long long frame);
+};
+
+// Records the enclosing scope as a zone of Profiler::Get()
+class ProfileScope
+{
+public:
+    ProfileScope(const char *name)
+        : zone(Profiler::Get().beginZone(name))
+    {
+    }
+
+    ~ProfileScope()
+    {
+        Profiler::Get().endZone(zone);
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    int zone;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileScope PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+#endif // !PROFILER_CLASS_H
@@ -0,0 +1,22 @@
+#ifndef PROFILER_WINDOW_CLASS_H
+#define PROFILER_WINDOW_CLASS_H
+
+#include "profiler.h"
+
+// ImGui window over a Profiler: frame times of every frame in the ring as
+// bars, and one frame's zones as a timeline with a row per lane and nesting
+// level. Clicking a bar pins that frame, clicking it again follows the
+// newest one. Export buttons write the whole ring as CSV or a Chrome trace.
+class ProfilerWindow
+{
+public:
+    // Frames to stay behind the newest when following, so the late GPU zones have landed
+    int followLag = 4;
+
+    void Draw(Profiler &profiler);
+
+private:
+    long long pinned = -1; // Frame number shown, -1 follows the newest
+};
+
+#endif // !PROFILER_WINDOW_CLASS_H
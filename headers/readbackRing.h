@@ -0,0 +1,148 @@
+#ifndef READBACK_RING_CLASS_H
+#define READBACK_RING_CLASS_H
+
+#include <glad/glad.h>
+
+#include <span>
+#include <vector>
+
+// Reads a GPU buffer back without stalling. Every enqueue() copies the buffer
+// into the next of a ring of persistently mapped buffers and drops a fence
+// behind the copy; latest() hands out the newest copy whose fence has
+// signalled. With three frames in flight the CPU sees frame N-2 while the GPU
+// works on N, and nothing ever waits.
+template <typename T>
+class ReadbackRing
+{
+public:
+    ReadbackRing(int frames = 3)
+        : slots(frames)
+    {
+    }
+
+    // Queues a copy of the first count records of buffer, call once a frame
+    void enqueue(GLuint buffer, int count, long long frame)
+    {
+        if (count > capacity)
+            reserve(count);
+
+        Slot &slot = slots[next];
+
+        // Overwriting a copy the CPU hasn't picked up yet is fine, but not one the GPU is still writing
+        if (slot.fence)
+        {
+            glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        if (next == ready)
+            ready = -1;
+
+        if (count > 0)
+        {
+            // Compute writes to buffer must land before the copy reads it
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(T) * count);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.count = count;
+        slot.frame = frame;
+        next = (next + 1) % (int)slots.size();
+    }
+
+    // Newest finished copy, empty until the first one lands. Valid until the
+    // next enqueue(), which may recycle its slot
+    std::span<const T> latest()
+    {
+        poll();
+        if (ready < 0)
+            return {};
+        return std::span<const T>(slots[ready].data, slots[ready].count);
+    }
+
+    // Frame passed to enqueue() for the copy latest() returns, -1 if none
+    long long latestFrame()
+    {
+        poll();
+        return ready < 0 ? -1 : slots[ready].frame;
+    }
+
+    void Delete()
+    {
+        for (Slot &slot : slots)
+        {
+            if (slot.fence)
+                glDeleteSync(slot.fence);
+            if (slot.buffer)
+            {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+                glDeleteBuffers(1, &slot.buffer);
+            }
+            slot = Slot();
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        capacity = 0;
+        ready = -1;
+    }
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        const T *data = nullptr;
+        int count = 0;
+        long long frame = -1;
+    };
+
+    std::vector<Slot> slots;
+    int capacity = 0;
+    int next = 0;
+    int ready = -1;
+
+    // Picks up every copy that finished since the last call, without blocking
+    void poll()
+    {
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            // Oldest first, so ready ends on the newest finished copy
+            int s = (next + (int)i) % (int)slots.size();
+            Slot &slot = slots[s];
+            if (!slot.fence)
+                continue;
+
+            GLenum status = glClientWaitSync(slot.fence, 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+            {
+                glDeleteSync(slot.fence);
+                slot.fence = nullptr;
+                ready = s;
+            }
+        }
+    }
+
+    // Immutable storage can't grow, so growing recreates every slot and drops what's in flight
+    void reserve(int count)
+    {
+        Delete();
+        capacity = count + count / 2;
+
+        const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        for (Slot &slot : slots)
+        {
+            glGenBuffers(1, &slot.buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+            glBufferStorage(GL_COPY_WRITE_BUFFER, sizeof(T) * capacity, nullptr, flags);
+            slot.data = (const T *)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, sizeof(T) * capacity, flags);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+};
+
+#endif // !READBACK_RING_CLASS_H
@@ -7,8 +7,39 @@
 #include <sstream>
 #include <iostream>
 #include <cerrno>
+#include <string_view>
+#include <unordered_map>
 
 std::string get_file_contents(const char *filename);
+// Same, with every #include "file" line replaced by that file (relative to the includer)
+std::string get_shader_source(const char *filename);
+
+// Locations of a program's active uniforms, read once after linking.
+// Lookups take a string_view, so literals and built names are found without
+// allocating, and names the linker dropped give -1 like glGetUniformLocation.
+// Members of uniform blocks have no location and are left out.
+class UniformTable
+{
+public:
+    void build(GLuint program);
+
+    GLint location(std::string_view name) const
+    {
+        auto found = locations.find(name);
+        return found == locations.end() ? -1 : found->second;
+    }
+
+    size_t size() const { return locations.size(); }
+
+private:
+    struct NameHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+    };
+
+    std::unordered_map<std::string, GLint, NameHash, std::equal_to<>> locations;
+};
 
 class Shader
 {
@@ -18,12 +49,17 @@ public:
     // Constructor that build the Shader Program from 2 different shaders
     Shader(const char *vertexFile, const char *fragmentFile);
 
+    // Location of a uniform, from the table built at link time
+    GLint uniform(std::string_view name) const { return uniforms.location(name); }
+
     // Activates the Shader Program
     void Activate();
     // Deletes the Shader Program
     void Delete();
 
 private:
+    UniformTable uniforms;
+
     // Checks if the different Shaders have compiled properly
     void compileErrors(unsigned int shader, const char *type);
 };
@@ -0,0 +1,36 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include "particleSystem.h"
+
+enum class SimdLevel
+{
+    Scalar,
+    SSE,
+    AVX2,
+    NEON
+};
+
+// Inner loops of the CPU solver over the ParticleSystem arrays. Every ISA
+// version performs the same operations in the same order as the scalar one
+// (no FMA), so results match it to within rounding.
+struct SimdKernels
+{
+    SimdLevel level;
+    const char *name;
+
+    // ParticleSystem::integrate over [begin, end)
+    void (*integrate)(ParticleSystem &ps, float dt, float g, int begin, int end);
+    // ParticleSystem::constraint over [begin, end)
+    void (*constraint)(ParticleSystem &ps, float r, int begin, int end);
+    // Writes the ids of particles closer than minDist to particle i into hits, returns how many
+    int (*findContacts)(const ParticleSystem &ps, int i, const int *ids, int count, float minDist, int *hits);
+};
+
+// Best level the CPU supports, detected on first use
+const SimdKernels &simdKernels();
+// A specific level, or the scalar kernels if the CPU (or build) lacks it
+const SimdKernels &simdKernels(SimdLevel level);
+bool simdSupported(SimdLevel level);
+
+#endif // !SIMD_KERNELS_H
@@ -0,0 +1,34 @@
+#ifndef SPATIAL_HASH_CLASS_H
+#define SPATIAL_HASH_CLASS_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// CPU counterpart of the hash table built in particle.comp: particles are
+// bucketed by grid cell with a counting sort so neighbours can be queried per cell
+class SpatialHash
+{
+public:
+    float spacing;
+    int tableSize;
+
+    // cellStart[h]..cellStart[h + 1] is the range of particleMap stored in bucket h
+    std::vector<int> cellStart;
+    std::vector<int> particleMap;
+
+    SpatialHash(float spacing, int maxNumObjs);
+
+    int intCoord(float coord) const;
+    unsigned int hashCoords(int xi, int yi, int zi) const;
+    unsigned int hashPos(const glm::vec3 &pos) const;
+
+    // Rebuilds the table for numObjs positions given as separate x/y/z arrays, growing it if needed
+    void create(int numObjs, const float *x, const float *y, const float *z);
+
+    // Fills queryIds with every particle stored in the cells overlapping pos +- maxDist
+    int query(const glm::vec3 &pos, float maxDist, std::vector<int> &queryIds) const;
+    // Same, for the block of cells between (x0, y0, z0) and (x1, y1, z1) inclusive
+    int queryCells(int x0, int y0, int z0, int x1, int y1, int z1, std::vector<int> &queryIds) const;
+};
+
+#endif // !SPATIAL_HASH_CLASS_H
@@ -0,0 +1,42 @@
+#ifndef UNIFORM_BUFFER_CLASS_H
+#define UNIFORM_BUFFER_CLASS_H
+
+#include <glad/glad.h>
+
+// A std140 uniform block's backing buffer, bound to its binding point for
+// good. T must match the block's std140 layout, e.g. gpu::FrameUniforms.
+template <typename T>
+class UniformBuffer
+{
+public:
+    GLuint ID;
+
+    UniformBuffer(GLuint binding)
+        : binding(binding)
+    {
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+    }
+
+    // One upload, seen by every program that declares the block
+    void update(const T &value)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &value);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+    }
+
+    void Delete()
+    {
+        glDeleteBuffers(1, &ID);
+    }
+
+private:
+    GLuint binding;
+};
+
+#endif // !UNIFORM_BUFFER_CLASS_H
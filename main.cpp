@@ -3,12 +3,32 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <random>
 #include <iostream>
+#include <thread>
+#include <cstdio>
 
 #include "light.h"
 #include "physx.h"
+#include "particleRenderer.h"
+#include "meshRegistry.h"
+#include "fixedTimestep.h"
+#include "gpuParticlePool.h"
+#include "gpuSpatialHash.h"
+#include "gpuParticleSort.h"
+#include "gpuEmitter.h"
+#include "gpuParticleSolver.h"
+#include "gpuParticleLod.h"
+#include "gpuParticleCull.h"
+#include "readbackRing.h"
+#include "profiler.h"
+#include "gpuProfiler.h"
+#include "profilerWindow.h"
+#include "frameUniforms.h"
+#include "uniformBuffer.h"
 #include "computeShader.h"
 #include "shaderClass.h"
 #include <GL/gl.h>
@@ -72,12 +92,13 @@ std::vector<glm::vec3> generateCubeSpherePoints(int pointsPerRow, float radius)
     return vertices;
 }
 
+// Seeded in main, so runs started with the same --seed spawn identically
+std::mt19937 rng;
+
 float randomFloat(float min, float max)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
     std::uniform_real_distribution<float> dis(min, max);
-    return dis(gen);
+    return dis(rng);
 }
 
 glm::vec3 randomVec3(float min, float max)
@@ -90,25 +111,25 @@ const unsigned int width = 1600;
 const unsigned int height = 900;
 
 std::vector<Model *> Model::models;
+std::unordered_map<std::string, std::unique_ptr<Model>> MeshRegistry::models;
 std::vector<Light *> Light::lights;
 int Light::pointLightCount = 0;
 
-std::vector<Particle *> Particle::particles;
-
-struct Obj
-{
-    alignas(16) glm::vec3 pos;
-    alignas(16) glm::vec3 vel;
-    alignas(16) glm::vec3 acc;
-    alignas(16) glm::vec3 newAcc;
-};
-
 int main(int argc, char *argv[])
 {
+    // --seed N makes spawning reproducible
+    unsigned int seed = std::random_device{}();
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--seed")
+            seed = (unsigned int)std::stoul(argv[i + 1]);
+    }
+    rng.seed(seed);
+
     // glfw: initialize and configure
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4); // 4.4 for glBufferStorage
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     // glfw window creation
@@ -137,64 +158,56 @@ int main(int argc, char *argv[])
         return -1;
     }
 
-    // Setup compute shader
-    ComputeShader computeShader("res/shaders/particle.comp");
-
     auto lastTime = std::chrono::high_resolution_clock::now();
 
+    // Both solver paths advance in fixed steps, independent of the frame rate
+    FixedTimestep timestep(1.0f / 120.0f, 8);
+    long long stepsAtLastSample = 0;
+    float stepsPerSecond = 0.0f;
+    float sampleTime = 0.0f;
+
     // Settings
     int numPoints = 12;
     float constraintRadius = 3.1f;
     float particleRadius = 0.1f;
-    int subSteps = 8;
+    int subSteps = 4;
     float maxSpeed = 3.333f;
     float pivotDist = 10.f;
 
-    // Setup particle data in an SSBO
-    std::vector<Obj> objs;
-
-    // Spatial Hashing Settings
-    float hashSpacing = particleRadius * 2.0f;
-    int maxNumObjs = 512;
-    int hashTableSize = 2 * maxNumObjs;
-
-    // // Add more particles if needed
-    // for (int i = 0; i < 10000; ++i)
-    // {
-    //     glm::vec3 randomOffset = randomVec3(-0.01f, 0.01f); // Small random perturbation
-    //     objs.push_back({{randomOffset}, {glm::vec3(0.0f)}, {0.0f, 0.0f, 0.0f}, particleRadius});
-    // }
-
-    GLuint ssbo;
-    glGenBuffers(1, &ssbo);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-
-    // Cell Count Buffer
-    GLuint cellCountBuffer;
-    glGenBuffers(1, &cellCountBuffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellCountBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * hashTableSize + 1, nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cellCountBuffer); // Binding = 1
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-
-    // Particle Map Buffer
-    GLuint particleMapBuffer;
-    glGenBuffers(1, &particleMapBuffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, particleMapBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * maxNumObjs, nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, particleMapBuffer); // Binding = 2
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-
-    // Query IDs Buffer
-    GLuint queryIdsBuffer;
-    glGenBuffers(1, &queryIdsBuffer);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, queryIdsBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * maxNumObjs, nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, queryIdsBuffer); // Binding = 3
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    // Particle state lives only on the GPU, in pools at bindings 0 and 10 that grow by doubling
+    GpuParticlePool particlePool;
+
+    // Spatial hash table at bindings 1..3, rebuilt on the GPU every step
+    GpuSpatialHash gpuHash(particleRadius * 2.0f);
+
+    // Optional reorder of the particle buffer by bucket, every sortInterval steps
+    GpuParticleSort particleSort;
+    bool sortByCell = true;
+    int sortInterval = 8;
+    long long stepsSinceSort = 0;
+
+    // Emits particles with a lifetime straight into the pool, off until enabled in the UI
+    GpuEmitter emitter;
+
+    // Contact solver: substeps, and the racy in-place or race-free modes
+    GpuParticleSolver solver;
+
+    // CPU zones (PROFILE_ZONE, including the Physx phases) and GPU timer
+    // queries per frame, shown in the Profiler window
+    Profiler &profiler = Profiler::Get();
+    GpuProfiler gpuProfiler;
+    ProfilerWindow profilerWindow;
+    bool showProfiler = false;
+
+    // Tags the readbacks below with the frame they were queued in
+    long long frameCount = 0;
+
+    // CPU copy of the GPU particles from two frames ago, for stats and export
+    ReadbackRing<gpu::Particle> particleReadback;
+    bool readback = false;
+
+    // The live count is the GPU's, the panel shows it a couple of frames late
+    ReadbackRing<gpu::ParticleCounters> counterReadback;
 
     // Setup shaders
     Shader shader("res/shaders/particle.vert", "res/shaders/particle.frag");
@@ -206,6 +219,9 @@ int main(int argc, char *argv[])
     glm::vec3 color(1.0f, 1.0f, 1.0f);
     glm::vec3 ambient(0.02f, 0.02f, 0.02f);
 
+    // Camera, sun and colours for every particle shader, see frameUniforms.h
+    UniformBuffer<gpu::FrameUniforms> frameUniforms(FRAME_UNIFORMS_BINDING);
+
     std::vector<glm::vec3>
         spherePoints = generateCubeSpherePoints(numPoints, constraintRadius);
 
@@ -226,36 +242,39 @@ int main(int argc, char *argv[])
 
     glBindVertexArray(0);
 
-    Model pModel("res/models/Shapes/icosphere.gltf", "particle", false);
-
-    std::vector<Vertex> vertices = pModel.meshes[0].vertices;
-    std::vector<GLuint> indices = pModel.meshes[0].indices;
-
-    GLuint pVAO, pVBO, pEBO;
-
-    glGenVertexArrays(1, &pVAO);
-    glGenBuffers(1, &pVBO);
-    glGenBuffers(1, &pEBO);
-
-    glBindVertexArray(pVAO);
-
-    // Set up vertex buffer (pVBO)
-    glBindBuffer(GL_ARRAY_BUFFER, pVBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
-
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, normal));
-    glEnableVertexAttribArray(1);
-
-    // Set up element buffer (pEBO)
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
+    // Every particle on both paths is an instance of this one icosphere
+    Mesh &particleMesh = MeshRegistry::GetMesh("res/models/Shapes/icosphere.gltf");
+    particlePool.setIndexCount(particleMesh.indices.size());
+
+    // CPU solver path, simulated by Physx and drawn straight from the SoA arrays
+    bool cpuSolver = false;
+    Physx physx;
+    ParticleSystem particleSystem;
+    ParticleRenderer particleRenderer(particleMesh);
+    Shader cpuShader("res/shaders/particleInstanced.vert", "res/shaders/particle.frag");
+    Shader cpuColorShader("res/shaders/particleInstancedColor.vert", "res/shaders/particleColor.frag");
+    bool colorBySpeed = false;
+    std::vector<glm::vec3> speedColors;
+
+    // Impostors draw every particle as a ray-traced quad instead of the icosphere
+    bool impostors = false;
+    Shader impostorShader("res/shaders/particleImpostor.vert", "res/shaders/particleImpostor.frag");
+    Shader cpuImpostorShader("res/shaders/particleImpostorInstanced.vert", "res/shaders/particleImpostor.frag");
+    GLuint impostorVAO; // Core profile draws need a VAO, even one without attributes
+    glGenVertexArrays(1, &impostorVAO);
+
+    // GPU mesh path: icosphere detail per particle from its size on screen
+    bool meshLod = false;
+    GpuParticleLod particleLod;
+    Shader lodShader("res/shaders/particleLod.vert", "res/shaders/particle.frag");
+    ReadbackRing<gpu::DrawCommand> lodReadback;
+
+    // GPU mesh path: skips particles outside the frustum or behind last frame's depth
+    bool culling = false;
+    GpuParticleCull particleCull;
+    Shader culledShader("res/shaders/particleCulled.vert", "res/shaders/particle.frag");
+    ReadbackRing<gpu::DrawCommand> visibleReadback;
+    ReadbackRing<gpu::CullStats> cullReadback;
 
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -268,49 +287,102 @@ int main(int argc, char *argv[])
     // Render loop
     while (!glfwWindowShouldClose(window))
     {
+        profiler.beginFrame();
+        gpuProfiler.collect(profiler);
+        gpuProfiler.beginFrame(profiler);
+        particleCull.beginFrame();
+
         auto currentTime = std::chrono::high_resolution_clock::now();
         std::chrono::duration<float> elapsed = currentTime - lastTime;
-        float dt = elapsed.count();
+        float frameDt = elapsed.count();
         lastTime = currentTime;
 
-        GLuint workgroupSize = 128; // This can be adjusted based on the GPU's capabilities
-
-        // Calculate number of workgroups needed
-        GLuint numWorkgroups = (objs.size() + workgroupSize - 1) / workgroupSize; // Ceil(particleCount / workgroupSize)
-
-        // Compute shader
-        computeShader.use();
-        computeShader.setFloat("dt", dt);
-        computeShader.setFloat("g", 9.81f);
-        computeShader.setFloat("cr", constraintRadius + 0.25f);
-        computeShader.setFloat("radius", particleRadius);
-        computeShader.setInt("particleCount", objs.size());
-        computeShader.setInt("subSteps", subSteps);
-        bool spacePressed = false;
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
-            spacePressed = true;
-
-        computeShader.setBool("pullToCenter", spacePressed);
-        computeShader.setFloat("maxSpeed", maxSpeed);
-        computeShader.setFloat("hash.spacing", hashSpacing);
-        computeShader.setInt("hash.maxObjs", maxNumObjs);
-        computeShader.setInt("hash.tableSize", hashTableSize);
-        // computeShader.setVec3("offset", lorenzOffset);
-
-        glDispatchCompute(numWorkgroups, 1, 1);
-        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        int steps = timestep.advance(frameDt);
+        float dt = timestep.step;
+
+        // Throughput in simulation steps rather than frames, sampled twice a second
+        sampleTime += frameDt;
+        if (sampleTime >= 0.5f)
+        {
+            stepsPerSecond = (timestep.totalSteps - stepsAtLastSample) / sampleTime;
+            stepsAtLastSample = timestep.totalSteps;
+            sampleTime = 0.0f;
+        }
+
+        // Compute solver
+        solver.subSteps = subSteps;
+        solver.containerRadius = constraintRadius + 0.25f;
+        solver.particleRadius = particleRadius;
+
+        {
+            PROFILE_ZONE("Simulate");
+            GpuProfileScope computeZone(gpuProfiler, "Compute");
+
+            for (int s = 0; s < steps; s++)
+            {
+                if (cpuSolver)
+                {
+                    physx.update(particleSystem, particleRadius, dt, 9.81f, constraintRadius, subSteps);
+                }
+                else
+                {
+                    // Expire particles first, so the emitter reuses their slots this step
+                    {
+                        GpuProfileScope lifeZone(gpuProfiler, "Lifetimes");
+                        particlePool.updateLifetimes(dt);
+                    }
+                    {
+                        GpuProfileScope emitZone(gpuProfiler, "Emit");
+                        emitter.emit(particlePool, dt);
+                    }
+
+                    bool sortNow = sortByCell && ++stepsSinceSort >= sortInterval;
+                    if (sortNow)
+                        stepsSinceSort = 0;
+
+                    GpuProfileScope stepZone(gpuProfiler, "Solver step");
+                    solver.step(particlePool, gpuHash, dt, sortNow ? &particleSort : nullptr);
+                }
+            }
+        }
+
+        counterReadback.enqueue(particlePool.counterBuffer, 1, frameCount);
+        if (readback && !cpuSolver)
+            particleReadback.enqueue(particlePool.buffer, particlePool.count, frameCount);
+
+        frameCount++;
 
         camera.Inputs(window, pivotDist);
         camera.updateMatrix(45.0f, 0.1f, 100.0f);
 
+        // Everything the particle shaders share, uploaded once for all of them
+        gpu::FrameUniforms frame = {};
+        frame.camMatrix = camera.cameraMatrix;
+        frame.view = camera.view;
+        frame.projection = camera.projection;
+        frame.camPos = camera.Position;
+        frame.alpha = timestep.alpha();
+        frame.sunDirection = sunDirection;
+        frame.color = color;
+        frame.ambient = ambient;
+        frameUniforms.update(frame);
+
+        int renderZone = profiler.beginZone("Render");
+
+        // The real drawable size, which differs from width and height after a
+        // resize or on a HiDPI display
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+
         // Render the cube
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        int boundsZone = gpuProfiler.beginZone("Bounds");
         icoboundsShader.Activate();
         glm::mat4 m = glm::mat4(1.0f);                      // Identity matrix
         m = glm::translate(m, glm::vec3(0.0f, 0.0f, 0.0f)); // Translate to center
-        glUniformMatrix4fv(glGetUniformLocation(icoboundsShader.ID, "model"), 1, GL_FALSE, glm::value_ptr(m));
-        glUniformMatrix4fv(glGetUniformLocation(icoboundsShader.ID, "camMatrix"), 1, GL_FALSE, glm::value_ptr(camera.cameraMatrix));
+        glUniformMatrix4fv(icoboundsShader.uniform("model"), 1, GL_FALSE, glm::value_ptr(m));
+        glUniformMatrix4fv(icoboundsShader.uniform("camMatrix"), 1, GL_FALSE, glm::value_ptr(camera.cameraMatrix));
 
         glPolygonMode(GL_FRONT_AND_BACK, GL_POINT); // Draw points
         glBindVertexArray(VAO);
@@ -318,25 +390,86 @@ int main(int argc, char *argv[])
         glBindVertexArray(0);
 
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        gpuProfiler.endZone(boundsZone);
 
-        shader.Activate();
-        glm::mat4 model = glm::mat4(1.0);
-        // model = glm::scale(model, glm::vec3(particleRadius));
-        glUniformMatrix4fv(glGetUniformLocation(shader.ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(glGetUniformLocation(shader.ID, "camMatrix"), 1, GL_FALSE, glm::value_ptr(camera.cameraMatrix));
-        glUniform1f(glGetUniformLocation(shader.ID, "scale"), particleRadius);
-        glUniform1f(glGetUniformLocation(shader.ID, "maxSpeed"), maxSpeed);
+        int particlesZone = gpuProfiler.beginZone("Particles");
 
         glEnable(GL_DEPTH_TEST);
 
-        glBindVertexArray(pVAO);
-        glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0, objs.size());
-        glBindVertexArray(0);
+        if (impostors)
+        {
+            Shader &s = cpuSolver ? cpuImpostorShader : impostorShader;
+            s.Activate();
 
-        glUniform3f(glGetUniformLocation(shader.ID, "sunDirection"), sunDirection.x, sunDirection.y, sunDirection.z);
-        glUniform3f(glGetUniformLocation(shader.ID, "color"), color.x, color.y, color.z);
-        glUniform3f(glGetUniformLocation(shader.ID, "ambient"), ambient.x, ambient.y, ambient.z);
+            if (cpuSolver)
+            {
+                particleRenderer.DrawImpostors(particleSystem, s);
+            }
+            else
+            {
+                glBindVertexArray(impostorVAO);
+                particlePool.drawArrays(GL_TRIANGLE_STRIP, 4);
+                glBindVertexArray(0);
+            }
+        }
+        else if (cpuSolver)
+        {
+            // Slow particles get the particle colour, ones at maxSpeed and faster go red
+            std::vector<glm::vec3> *colors = nullptr;
+            if (colorBySpeed)
+            {
+                speedColors.resize(particleSystem.size());
+                for (size_t i = 0; i < particleSystem.size(); i++)
+                {
+                    glm::vec3 v(particleSystem.vx[i], particleSystem.vy[i], particleSystem.vz[i]);
+                    float t = std::min(glm::length(v) / maxSpeed, 1.0f);
+                    speedColors[i] = glm::mix(color, glm::vec3(1.0f, 0.15f, 0.05f), t);
+                }
+                colors = &speedColors;
+            }
+
+            Shader &instancedShader = colorBySpeed ? cpuColorShader : cpuShader;
+            particleRenderer.Draw(particleSystem, instancedShader, colors);
+        }
+        else if (meshLod)
+        {
+            particleLod.bucket(particlePool, camera.cameraMatrix, camera.projection[1][1] * framebufferHeight / 2.0f, timestep.alpha(), culling ? &particleCull : nullptr);
+            lodReadback.enqueue(particleLod.commandBuffer, GpuParticleLod::levels, frameCount);
+
+            lodShader.Activate();
+            particleLod.draw();
+        }
+        else if (culling)
+        {
+            particleCull.cull(particlePool, camera.cameraMatrix, timestep.alpha());
+            visibleReadback.enqueue(particleCull.commandBuffer, 1, frameCount);
+
+            culledShader.Activate();
+            particleMesh.VAO.Bind();
+            particleCull.drawElements();
+            particleMesh.VAO.Unbind();
+        }
+        else
+        {
+            shader.Activate();
+
+            // Radius comes from each particle's record
+            particleMesh.VAO.Bind();
+            particlePool.drawElements();
+            particleMesh.VAO.Unbind();
+        }
 
+        // This frame's depth is what next frame's particles are tested against
+        if (culling && !impostors && !cpuSolver)
+        {
+            GpuProfileScope hiZZone(gpuProfiler, "Hi-Z");
+            cullReadback.enqueue(particleCull.statsBuffer, 1, frameCount);
+            particleCull.updateHiZ(framebufferWidth, framebufferHeight);
+        }
+        gpuProfiler.endZone(particlesZone);
+        profiler.endZone(renderZone);
+
+        int imguiZone = profiler.beginZone("ImGui");
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -346,11 +479,72 @@ int main(int argc, char *argv[])
         ImGui::TextColored(ImVec4(128.0f, 0.0f, 128.0f, 255.0f), "Stats & Settings");
         ImGui::Text("FPS: %.1f", io.Framerate);
         ImGui::Text("Frame time: %.3f ms", 1000.0f / io.Framerate);
+        ImGui::Text("Sim steps/s: %.0f", stepsPerSecond);
+        ImGui::Text("GPU compute: %.3f ms/frame", profiler.averageMs("Compute", ProfileLane::Gpu, 10));
+        ImGui::Checkbox("Show Profiler", &showProfiler);
         // ImGui::DragFloat3("Camera Pos", &camera.Position[0], 0.1f);
         // ImGui::DragFloat3("Camera Orientation", &camera.Orientation[0], 0.1f);
         ImGui::Spacing();
 
-        ImGui::TextColored(ImVec4(0.0f, 128.0f, 0.0f, 255.0f), "Particle Count: %i", objs.size());
+        std::span<const gpu::ParticleCounters> counters = counterReadback.latest();
+        int gpuParticleCount = counters.empty() ? 0 : (int)counters[0].slotCount;
+        ImGui::TextColored(ImVec4(0.0f, 128.0f, 0.0f, 255.0f), "Particle Count: %i", cpuSolver ? (int)particleSystem.size() : gpuParticleCount);
+        if (!cpuSolver && !counters.empty())
+            ImGui::Text("Alive: %u, free slots: %i, awake: %u", counters[0].aliveCount, counters[0].freeCount, counters[0].activeCount);
+        if (cpuSolver && physx.sleeping)
+            ImGui::Text("Awake: %i", physx.awakeCount());
+        ImGui::Checkbox("CPU Solver", &cpuSolver);
+        if (!cpuSolver)
+        {
+            ImGui::Checkbox("Read Back State", &readback);
+            std::span<const gpu::Particle> state = particleReadback.latest();
+            if (readback && !state.empty())
+            {
+                float fastest = 0.0f;
+                double kineticEnergy = 0.0;
+                for (const gpu::Particle &p : state)
+                {
+                    if (!(gpu::particleFlags(p) & PARTICLE_FLAG_ALIVE))
+                        continue;
+                    glm::vec3 v = gpu::particleVelocity(p);
+                    fastest = std::max(fastest, glm::length(v));
+                    kineticEnergy += 0.5 * glm::dot(v, v);
+                }
+                ImGui::Text("Frame %lld: max speed %.3f, KE %.3f", particleReadback.latestFrame(), fastest, kineticEnergy);
+
+                // Same columns as physxgl_sim --dump, rows in buffer order, dead slots left out
+                if (ImGui::Button("Export CSV"))
+                {
+                    FILE *file = std::fopen("particles.csv", "w");
+                    if (file == nullptr)
+                    {
+                        std::cout << "Unable to open particles.csv for writing" << std::endl;
+                    }
+                    else
+                    {
+                        std::fprintf(file, "x,y,z,vx,vy,vz\n");
+                        for (const gpu::Particle &p : state)
+                        {
+                            if (!(gpu::particleFlags(p) & PARTICLE_FLAG_ALIVE))
+                                continue;
+                            glm::vec3 x = gpu::particlePosition(p);
+                            glm::vec3 v = gpu::particleVelocity(p);
+                            std::fprintf(file, "%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n", x.x, x.y, x.z, v.x, v.y, v.z);
+                        }
+                        std::fclose(file);
+                    }
+                }
+            }
+        }
+        if (cpuSolver)
+        {
+            static int physxThreads = physx.threadCount();
+            if (ImGui::SliderInt("Threads", &physxThreads, 1, (int)std::thread::hardware_concurrency()))
+                physx.setThreadCount(physxThreads);
+            ImGui::Checkbox("Color By Speed", &colorBySpeed);
+            if (colorBySpeed)
+                ImGui::DragFloat("Max Speed", &maxSpeed, 0.01f, 0.01f, 100.0f);
+        }
 
         ImGui::Spacing();
         ImGui::Separator();
@@ -358,14 +552,130 @@ int main(int argc, char *argv[])
         ImGui::DragFloat3("Sun Direction", &sunDirection[0], 0.1f);
         ImGui::ColorEdit3("Particle Color", &color[0], 0.1f);
         ImGui::ColorEdit3("Ambient Lighting", &ambient[0], 0.1f);
+        const char *renderModes[] = {"Icosphere Mesh", "Sphere Impostors"};
+        int renderMode = impostors ? 1 : 0;
+        if (ImGui::Combo("Particle Rendering", &renderMode, renderModes, 2))
+            impostors = renderMode == 1;
+        if (!impostors && !cpuSolver)
+        {
+            ImGui::Checkbox("Culling", &culling);
+            if (culling)
+            {
+                ImGui::SameLine();
+                ImGui::Checkbox("Frustum", &particleCull.frustum);
+                ImGui::SameLine();
+                ImGui::Checkbox("Occlusion (Hi-Z)", &particleCull.occlusion);
+
+                // Visible is what the draws were given, so the LOD lists when those are on
+                std::span<const gpu::DrawCommand> visibleCommands = meshLod ? lodReadback.latest() : visibleReadback.latest();
+                std::span<const gpu::CullStats> cullStats = cullReadback.latest();
+                if (!visibleCommands.empty() && !cullStats.empty())
+                {
+                    unsigned int visible = 0;
+                    for (const gpu::DrawCommand &command : visibleCommands)
+                        visible += command.instanceCount;
+                    ImGui::Text("Visible: %u, culled: %u (frustum %u, occluded %u)", visible,
+                                cullStats[0].frustumCulled + cullStats[0].occlusionCulled, cullStats[0].frustumCulled, cullStats[0].occlusionCulled);
+                }
+            }
+
+            ImGui::Checkbox("Mesh LOD", &meshLod);
+            std::span<const gpu::DrawCommand> lodCommands = lodReadback.latest();
+            if (meshLod)
+            {
+                ImGui::DragFloat3("LOD Pixels", particleLod.lodPixels, 0.5f, 0.0f, 1000.0f);
+                int triangles = 0;
+                for (int l = 0; l < (int)lodCommands.size(); l++)
+                {
+                    ImGui::Text("LOD %i (%i tris): %u", l, particleLod.triangleCount(l), lodCommands[l].instanceCount);
+                    triangles += particleLod.triangleCount(l) * (int)lodCommands[l].instanceCount;
+                }
+                if (!lodCommands.empty())
+                    ImGui::Text("Particle triangles: %i", triangles);
+            }
+        }
         // ImGui::DragFloat("Particle Radius", &particleRadius, 0.1f);
         // ImGui::DragFloat("Max Speed", &maxSpeed, 0.001f);
         // ImGui::DragFloat("Pivot Dist", &pivotDist, 0.1f);
 
         ImGui::TextColored(ImVec4(0.0f, 128.0f, 128.0f, 255.0f), "Spatial Hashing Settings");
-        ImGui::DragFloat("Spacing", &hashSpacing);
+        // The coloured sweep is race-free and the solvers' +-1 cell search finds every
+        // contact only while a cell is at least a diameter wide
+        ImGui::DragFloat("Spacing", &gpuHash.spacing, 0.01f, particleRadius * 2.0f, particleRadius * 16.0f);
+        gpuHash.spacing = std::max(gpuHash.spacing, particleRadius * 2.0f);
+        ImGui::Checkbox("Sort By Cell", &sortByCell);
+        if (sortByCell)
+            ImGui::SliderInt("Sort Every (steps)", &sortInterval, 1, 64);
+
+        ImGui::TextColored(ImVec4(0.0f, 128.0f, 128.0f, 255.0f), "Emitter");
+        ImGui::Checkbox("Emit (GPU)", &emitter.enabled);
+        if (emitter.enabled)
+        {
+            const char *shapes[] = {"Point", "Sphere", "Disc"};
+            int shape = (int)emitter.shape;
+            if (ImGui::Combo("Shape", &shape, shapes, 3))
+                emitter.shape = (EmitterShape)shape;
+            ImGui::DragFloat("Rate (/s)", &emitter.rate, 1.0f, 0.0f, 100000.0f);
+            ImGui::DragFloat3("Emitter Position", &emitter.position[0], 0.1f);
+            if (emitter.shape != EmitterShape::Point)
+                ImGui::DragFloat("Emitter Size", &emitter.size, 0.05f, 0.0f, 100.0f);
+            if (emitter.shape == EmitterShape::Disc)
+                ImGui::DragFloat3("Disc Normal", &emitter.axis[0], 0.05f);
+            ImGui::DragFloat3("Velocity", &emitter.velocity[0], 0.1f);
+            ImGui::DragFloat("Velocity Spread", &emitter.velocitySpread, 0.05f, 0.0f, 100.0f);
+            ImGui::DragFloat("Radial Speed", &emitter.radialSpeed, 0.05f);
+            ImGui::DragFloat("Lifetime (s)", &emitter.lifetime, 0.05f, 0.01f, 600.0f);
+            ImGui::DragFloat("Lifetime Spread", &emitter.lifetimeSpread, 0.05f, 0.0f, 600.0f);
+            emitter.particleRadius = particleRadius;
+        }
 
-        ImGui::DragInt("Sub Steps", &subSteps);
+        ImGui::SliderInt("Sub Steps", &subSteps, 1, 32);
+        if (cpuSolver)
+        {
+            bool xpbd = physx.contactModel == ContactModel::Xpbd;
+            if (ImGui::Checkbox("XPBD Contacts", &xpbd))
+                physx.contactModel = xpbd ? ContactModel::Xpbd : ContactModel::Impulse;
+            if (xpbd)
+            {
+                ImGui::DragFloat("Compliance", &physx.compliance, 1e-6f, 0.0f, 1e-2f, "%.2e");
+                ImGui::DragFloat("Damping", &physx.damping, 0.1f, 0.0f, 100.0f);
+            }
+        }
+        else
+        {
+            const char *modes[] = {"Direct (racy)", "Jacobi", "Coloured Gauss-Seidel", "XPBD (coloured)"};
+            int mode = (int)solver.mode;
+            if (ImGui::Combo("Contact Solver", &mode, modes, 4))
+                solver.mode = (SolverMode)mode;
+            if (solver.mode == SolverMode::Direct)
+                ImGui::SliderInt("Sub Steps Per Hash", &solver.substepsPerHash, 1, subSteps);
+            else
+                ImGui::SliderInt("Iterations", &solver.iterations, 1, 8);
+            if (solver.mode == SolverMode::Jacobi)
+                ImGui::SliderFloat("Relaxation", &solver.relaxation, 0.1f, 2.0f);
+            if (solver.mode == SolverMode::Xpbd)
+            {
+                ImGui::DragFloat("Compliance", &solver.compliance, 1e-6f, 0.0f, 1e-2f, "%.2e");
+                ImGui::DragFloat("Damping", &solver.damping, 0.1f, 0.0f, 100.0f);
+            }
+        }
+        // One set of sleep settings for both solvers
+        ImGui::Checkbox("Sleeping", &physx.sleeping);
+        if (physx.sleeping)
+        {
+            ImGui::DragFloat("Sleep Speed", &physx.sleepSpeed, 0.005f, 0.0f, 10.0f);
+            ImGui::DragFloat("Sleep Time (s)", &physx.sleepTime, 0.01f, 0.0f, 2.0f);
+            ImGui::DragFloat("Wake Energy", &physx.wakeEnergy, 0.005f, 0.0f, 10.0f);
+        }
+        solver.sleeping = physx.sleeping;
+        solver.sleepSpeed = physx.sleepSpeed;
+        solver.sleepTime = physx.sleepTime;
+        solver.wakeEnergy = physx.wakeEnergy;
+
+        static float stepRate = 1.0f / timestep.step;
+        if (ImGui::DragFloat("Step Rate (Hz)", &stepRate, 1.0f, 10.0f, 1000.0f))
+            timestep.step = 1.0f / stepRate;
+        ImGui::DragInt("Max Steps/Frame", &timestep.maxStepsPerFrame, 1.0f, 1, 64);
         static int spawnCount = 1;                      // Default spawn count
         ImGui::InputInt("Particle Count", &spawnCount); // Input box to adjust count
         if (spawnCount < 1)
@@ -374,40 +684,71 @@ int main(int argc, char *argv[])
         // Button to spawn particles
         if (ImGui::Button("Spawn Particle(s)"))
         {
+            // Batched, so a click uploads its particles once instead of the whole pool per particle
+            std::vector<gpu::Particle> spawned;
+            std::vector<gpu::ParticleRender> spawnedRenders;
+
             for (int i = 0; i < spawnCount; i++)
             {
                 // Generate a random position and velocity for the new particle
                 glm::vec3 randomPos = randomVec3(-constraintRadius, constraintRadius);
 
-                // Create the new particle object
-                Obj newParticle = {{randomPos}, {glm::vec3(0)}, {glm::vec3(0)}, {glm::vec3(0)}};
-
-                // Add the new particle to the 'objs' vector
-                objs.push_back(newParticle);
-
-                hashTableSize = 5 * objs.size();
+                if (cpuSolver)
+                {
+                    particleSystem.spawn(randomPos, glm::vec3(0), particleRadius);
+                    continue;
+                }
 
-                // Resize the SSBO to accommodate the new particle
-                glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-                glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Obj) * objs.size(), objs.data(), GL_DYNAMIC_DRAW);
-                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
-                glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+                spawned.push_back(gpu::packParticle(randomPos, glm::vec3(0), particleRadius));
+                spawnedRenders.push_back({glm::vec4(randomPos, 1.0f)});
             }
+
+            // The append pass finds the new particles their slots on the GPU
+            particlePool.append(spawned.data(), spawnedRenders.data(), (int)spawned.size());
         }
         ImGui::End();
 
+        if (showProfiler)
+            profilerWindow.Draw(profiler);
+
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            GpuProfileScope imguiGpuZone(gpuProfiler, "ImGui");
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
+        profiler.endZone(imguiZone);
+        gpuProfiler.endFrame();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            // Includes waiting for vsync
+            PROFILE_ZONE("Swap");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        profiler.endFrame();
     }
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
-    glDeleteProgram(computeShader.ID);
+    solver.Delete();
+    particlePool.Delete();
+    gpuHash.Delete();
+    particleSort.Delete();
+    emitter.Delete();
+    particleReadback.Delete();
+    counterReadback.Delete();
+    gpuProfiler.Delete();
+    particleRenderer.Delete();
+    glDeleteVertexArrays(1, &impostorVAO);
+    particleLod.Delete();
+    lodReadback.Delete();
+    particleCull.Delete();
+    visibleReadback.Delete();
+    cullReadback.Delete();
+    frameUniforms.Delete();
+    MeshRegistry::Clear();
 
     glfwTerminate();
 
@@ -0,0 +1,77 @@
+#ifndef CULL_GLSL
+#define CULL_GLSL
+
+// Sphere visibility for the particle culling passes, set up by
+// GpuParticleCull::prepare(). A sphere is culled if it lies outside one of
+// the frustum planes, or if its screen rectangle is wholly behind the
+// farthest depth the previous frame's Hi-Z pyramid holds over it.
+
+layout(std430, binding = 24) buffer CullStatsBuffer {
+    CullStats cullStats;
+};
+
+uniform mat4 cullMatrix;        // This frame's camera matrix
+uniform vec4 frustumPlanes[6];  // xyz inward normal, w offset, normalised
+uniform bool frustumCull;
+uniform bool occlusionCull;     // False until a pyramid for the last frame exists
+uniform sampler2D hiZ;          // Max depth pyramid, r32f
+uniform ivec2 hiZSize;          // Level 0, the viewport
+uniform int hiZLevels;
+
+// Farthest depth over the window-space pixel rectangle lo..hi, read from the
+// level where it spans at most 2x2 texels
+float hiZDepth(ivec2 lo, ivec2 hi) {
+    ivec2 extent = hi - lo + 1;
+    int level = min(int(ceil(log2(float(max(extent.x, extent.y))))), hiZLevels - 1);
+
+    ivec2 last = max(hiZSize >> level, ivec2(1)) - 1;
+    ivec2 a = min(lo >> level, last);
+    ivec2 b = min(hi >> level, last);
+    return max(max(texelFetch(hiZ, a, level).r, texelFetch(hiZ, ivec2(b.x, a.y), level).r),
+               max(texelFetch(hiZ, ivec2(a.x, b.y), level).r, texelFetch(hiZ, b, level).r));
+}
+
+bool occluded(vec3 center, float radius) {
+    // Screen bounds and nearest depth of the sphere's bounding cube
+    vec3 lo = vec3(1.0);
+    vec3 hi = vec3(-1.0);
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = cullMatrix * vec4(corner, 1.0);
+
+        // Crosses the near plane, the projection says nothing useful
+        if (clip.w <= 1e-4)
+            return false;
+
+        vec3 ndc = clip.xyz / clip.w;
+        lo = min(lo, ndc);
+        hi = max(hi, ndc);
+    }
+
+    vec2 size = vec2(hiZSize);
+    ivec2 pixelLo = clamp(ivec2((lo.xy * 0.5 + 0.5) * size), ivec2(0), hiZSize - 1);
+    ivec2 pixelHi = clamp(ivec2((hi.xy * 0.5 + 0.5) * size), ivec2(0), hiZSize - 1);
+
+    return lo.z * 0.5 + 0.5 > hiZDepth(pixelLo, pixelHi);
+}
+
+// Counts the particle into cullStats if it is culled
+bool sphereVisible(vec3 center, float radius) {
+    if (frustumCull) {
+        for (int i = 0; i < 6; i++) {
+            if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius) {
+                atomicAdd(cullStats.frustumCulled, 1u);
+                return false;
+            }
+        }
+    }
+
+    if (occlusionCull && occluded(center, radius)) {
+        atomicAdd(cullStats.occlusionCulled, 1u);
+        return false;
+    }
+
+    return true;
+}
+
+#endif // CULL_GLSL
@@ -0,0 +1,8 @@
+#ifndef FRAME_GLSL
+#define FRAME_GLSL
+
+// camMatrix, view, projection, camPos, alpha, sunDirection, color and
+// ambient, see headers/frameUniforms.h
+#include "../../../headers/frameUniforms.h"
+
+#endif // FRAME_GLSL
@@ -0,0 +1,45 @@
+#ifndef HASH_GLSL
+#define HASH_GLSL
+
+// Spatial hash shared by the build passes and the solver. After a build,
+// particleMap[cellStart[h]] .. particleMap[cellStart[h + 1] - 1] are the
+// particles in bucket h.
+
+struct Hash {
+    float spacing;
+    int maxObjs;
+    int tableSize;
+};
+
+uniform Hash hash;
+
+layout(std430, binding = 1) buffer CellCountBuffer {
+    int cellStart[]; // hash.tableSize + 1 entries
+};
+
+layout(std430, binding = 2) buffer ParticleMapBuffer {
+    int particleMap[];
+};
+
+layout(std430, binding = 3) buffer CellIdsBuffer {
+    uint cellIds[]; // Bucket of every particle, written by the count pass
+};
+
+uint hashCoords(int xi, int yi, int zi) {
+    uint h = uint(xi) * 92837111u ^ uint(yi) * 689287499u ^ uint(zi) * 283923481u;
+    return h % uint(hash.tableSize);
+}
+
+int intCoord(float coord) {
+    return int(floor(coord / hash.spacing));
+}
+
+uint hashPos(vec3 pos) {
+    int xi = intCoord(pos.x);
+    int yi = intCoord(pos.y);
+    int zi = intCoord(pos.z);
+
+    return hashCoords(xi, yi, zi);
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef IMPOSTOR_GLSL
+#define IMPOSTOR_GLSL
+
+// Sphere impostors: every particle is one camera-facing quad, and the
+// fragment shader ray-traces the sphere inside it. Vertex work is four
+// vertices a particle instead of the icosphere's.
+
+#include "frame.glsl"
+
+// View-space corner `vertex` (0..3, a triangle strip) of the quad covering
+// a sphere at view-space center c. The quad sits at the center facing the
+// eye, and is sized to the silhouette cone rather than the radius, or
+// perspective would clip the sphere's edges.
+vec3 impostorCorner(vec3 c, float radius, int vertex) {
+    vec2 corner = vec2(vertex & 1, vertex >> 1) * 2.0 - 1.0;
+
+    float d2 = dot(c, c);
+    float halfSize = radius * sqrt(d2 / max(d2 - radius * radius, 1e-6));
+
+    vec3 forward = normalize(c);
+    vec3 right = normalize(cross(forward, abs(forward.y) < 0.999 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 up = cross(right, forward);
+    return c + (corner.x * right + corner.y * up) * halfSize;
+}
+
+// Nearest hit of the eye ray through view-space point p with the sphere,
+// false if it misses
+bool impostorHit(vec3 p, vec3 c, float radius, out vec3 hit) {
+    vec3 dir = normalize(p);
+    float b = dot(dir, c);
+    float disc = b * b - dot(c, c) + radius * radius;
+    if (disc < 0.0)
+        return false;
+    hit = dir * (b - sqrt(disc));
+    return true;
+}
+
+// Window-space depth of a view-space point, for gl_FragDepth
+float impostorDepth(vec3 p) {
+    vec4 clip = projection * vec4(p, 1.0);
+    float ndcZ = clip.z / clip.w;
+    return 0.5 * (gl_DepthRange.diff * ndcZ + gl_DepthRange.near + gl_DepthRange.far);
+}
+
+#endif
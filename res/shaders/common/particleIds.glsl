@@ -0,0 +1,11 @@
+#ifndef PARTICLE_IDS_GLSL
+#define PARTICLE_IDS_GLSL
+
+// Spawn index of the particle in each slot. Slots get recycled and the cell
+// sort moves particles around, the spawn index is what stays with a particle.
+
+layout(std430, binding = 6) buffer ParticleIdsBuffer {
+    uint particleIds[];
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef PARTICLES_GLSL
+#define PARTICLES_GLSL
+
+// The record layout is shared with C++, see headers/particleLayout.h
+#include "../../../headers/particleLayout.h"
+
+layout(std430, binding = 0) buffer Particles {
+    Particle particles[];
+};
+
+layout(std430, binding = 10) buffer ParticleRenders {
+    ParticleRender particleRenders[];
+};
+
+layout(std430, binding = 12) buffer ParticleCountersBuffer {
+    ParticleCounters counters; // counters.slotCount is the number of slots every pass goes over
+};
+
+layout(std430, binding = 16) buffer ParticleLifetimes {
+    float lifetimes[]; // Seconds left, negative lives forever
+};
+
+layout(std430, binding = 18) buffer FreeSlots {
+    uint freeSlots[]; // counters.freeCount dead slots, rebuilt by particleLife.comp, emptied by a sort
+};
+
+layout(std430, binding = 21) buffer ActiveSlots {
+    uint activeSlots[]; // counters.activeCount awake slots, rebuilt by particleSleep.comp
+};
+
+uint restSteps(uint flags) {
+    return (flags >> PARTICLE_REST_SHIFT) & PARTICLE_REST_MAX;
+}
+
+uint withRestSteps(uint flags, uint steps) {
+    return (flags & ~(PARTICLE_REST_MAX << PARTICLE_REST_SHIFT)) | (min(steps, PARTICLE_REST_MAX) << PARTICLE_REST_SHIFT);
+}
+
+// A slot for a new particle: a dead one off the free list, else a fresh one
+// past slotCount. Returns capacity or more when the pool is full. The free
+// list is only valid from the life pass to the next sort, which moves
+// particles between slots; GpuParticleSort::sort() empties it.
+uint acquireSlot() {
+    int free = atomicAdd(counters.freeCount, -1) - 1;
+    if (free >= 0)
+        return freeSlots[free];
+    return atomicAdd(counters.slotCount, 1u);
+}
+
+// Unpacked particle the solver works on, whatever the storage layout
+struct ParticleState {
+    vec3 pos;
+    float radius;
+    vec3 vel;
+    uint flags;
+};
+
+#ifdef PARTICLE_LAYOUT_HALF
+
+ParticleState unpackParticle(ParticleHalf p) {
+    vec2 velXY = unpackHalf2x16(p.velXY);
+    vec2 velZRadius = unpackHalf2x16(p.velZRadius);
+    return ParticleState(vec3(p.px, p.py, p.pz), velZRadius.y, vec3(velXY, velZRadius.x), p.flags);
+}
+
+ParticleState loadParticle(uint i) {
+    return unpackParticle(particles[i]);
+}
+
+void storeParticle(uint i, ParticleState s) {
+    particles[i] = ParticleHalf(s.pos.x, s.pos.y, s.pos.z, s.flags,
+                                packHalf2x16(s.vel.xy), packHalf2x16(vec2(s.vel.z, s.radius)));
+}
+
+vec3 loadPosition(uint i) {
+    return vec3(particles[i].px, particles[i].py, particles[i].pz);
+}
+
+float loadRadius(uint i) {
+    return unpackHalf2x16(particles[i].velZRadius).y;
+}
+
+uint loadFlags(uint i) {
+    return particles[i].flags;
+}
+
+void storeFlags(uint i, uint flags) {
+    particles[i].flags = flags;
+}
+
+#else
+
+ParticleState unpackParticle(ParticleFull p) {
+    return ParticleState(p.posRadius.xyz, p.posRadius.w, p.vel, p.flags);
+}
+
+ParticleState loadParticle(uint i) {
+    return unpackParticle(particles[i]);
+}
+
+void storeParticle(uint i, ParticleState s) {
+    particles[i] = ParticleFull(vec4(s.pos, s.radius), s.vel, s.flags);
+}
+
+vec3 loadPosition(uint i) {
+    return particles[i].posRadius.xyz;
+}
+
+float loadRadius(uint i) {
+    return particles[i].posRadius.w;
+}
+
+uint loadFlags(uint i) {
+    return particles[i].flags;
+}
+
+void storeFlags(uint i, uint flags) {
+    particles[i].flags = flags;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef SOLVER_GLSL
+#define SOLVER_GLSL
+
+// Integration, contact response and container constraint, shared by every
+// solver mode. Include after particles.glsl.
+
+uniform float dt;    // One substep
+uniform int subStep; // Index of the dispatch's first substep within the frame step
+uniform float g;
+uniform float cr;
+uniform float radius;
+uniform float compliance; // XPBD only, inverse contact stiffness, 0 is rigid
+uniform float damping;    // XPBD only
+uniform uint sleepSteps;  // Steps at rest before a particle sleeps, 0 never
+uniform float wakeEnergy; // Relative kinetic energy a contact needs to wake a sleeping particle
+
+// Positions at the start of the substep, XPBD derives velocities from them
+layout(std430, binding = 20) buffer StartPositions {
+    vec4 startPositions[];
+};
+
+bool isAsleep(uint flags) {
+    return sleepSteps > 0u && restSteps(flags) >= sleepSteps;
+}
+
+// A contact this hard wakes a sleeping particle and restarts the rest count
+// of both, so a pile only falls asleep once all of it rests. Only a particle
+// that moved last step counts, the velocity of one at rest is mostly noise
+// from contacts that can't all be satisfied.
+bool wakes(ParticleState p, ParticleState other) {
+    vec3 relVel = p.vel - other.vel;
+    bool moving = restSteps(p.flags) == 0u || restSteps(other.flags) == 0u;
+    return sleepSteps > 0u && moving && 0.5 * dot(relVel, relVel) > wakeEnergy;
+}
+
+// What a contact with other does to p, nothing unless they overlap. The
+// other particle gets exactly the opposite.
+bool contactResponse(ParticleState p, ParticleState other, out vec3 dPos, out vec3 dVel) {
+    dPos = vec3(0.0);
+    dVel = vec3(0.0);
+
+    vec3 axis = p.pos - other.pos;
+    float dist = length(axis);
+    if (dist >= p.radius + other.radius || dist == 0.0)
+        return false;
+
+    // Calculate collision normal
+    vec3 collisionNormal = axis / dist;
+
+    // Compute overlap, split evenly
+    float overlap = p.radius + other.radius - dist;
+    dPos = collisionNormal * (overlap / 2.0);
+
+    // Impulse along the normal from the relative velocity, restitution coefficient for bounciness
+    float impulseMagnitude = dot(p.vel - other.vel, collisionNormal);
+    float restitution = 0.8;
+    dVel = -collisionNormal * impulseMagnitude * restitution * 0.5;
+    return true;
+}
+
+// Resolves a contact by writing both particles. A sleeping particle that
+// isn't woken is static and the other takes the whole response.
+void handleCollision(inout ParticleState p1, inout ParticleState p2) {
+    vec3 dPos;
+    vec3 dVel;
+    if (contactResponse(p1, p2, dPos, dVel)) {
+        if (wakes(p1, p2)) {
+            p1.flags = withRestSteps(p1.flags, 0u);
+            p2.flags = withRestSteps(p2.flags, 0u);
+        }
+
+        float w1 = isAsleep(p1.flags) ? 0.0 : 1.0;
+        float w2 = isAsleep(p2.flags) ? 0.0 : 1.0;
+        if (w1 + w2 == 0.0)
+            return;
+
+        p1.pos += dPos * (2.0 * w1 / (w1 + w2));
+        p1.vel += dVel * (2.0 * w1 / (w1 + w2));
+        p2.pos -= dPos * (2.0 * w2 / (w1 + w2));
+        p2.vel -= dVel * (2.0 * w2 / (w1 + w2));
+    }
+}
+
+// XPBD contact between p and other, unit masses unless other is static
+// (wOther 0), one iteration per substep so the multiplier starts from zero.
+// Returns what p moves by, other moves by the opposite times wOther.
+// alphaTilde softens the contact, gamma damps how fast it closed during the
+// substep (Macklin et al. 2016, eq. 26).
+vec3 xpbdContact(ParticleState p, ParticleState other, vec3 pStart, vec3 otherStart, float wOther) {
+    vec3 axis = other.pos - p.pos;
+    float dist = length(axis);
+    if (dist >= p.radius + other.radius || dist == 0.0)
+        return vec3(0.0);
+
+    vec3 n = axis / dist;
+    float alphaTilde = compliance / (dt * dt);
+    float gamma = compliance * damping / dt;
+    float C = dist - (p.radius + other.radius);
+    float closing = dot(n, (other.pos - otherStart) * wOther - (p.pos - pStart));
+    float deltaLambda = (-C - gamma * closing) / ((1.0 + gamma) * (1.0 + wOther) + alphaTilde);
+    return -n * deltaLambda;
+}
+
+void applyForce(inout vec3 newAcc, vec3 f) {
+    newAcc += f;
+}
+
+void updatePositions(inout ParticleState p, float dt) {
+    vec3 newAcc = vec3(0);
+
+    applyForce(newAcc, vec3(0,-g,0));
+
+    vec3 friction = vec3(0);
+    if(length(p.vel) > 0.001){
+        vec3 frictionDir = normalize(p.vel);
+        vec3 frictionForce = -frictionDir * 0.2 * length(p.vel);
+        applyForce(newAcc, frictionForce);
+    }
+
+    vec3 newPos = p.pos + p.vel * dt + newAcc * (dt * dt * 0.5);
+
+    // The acceleration isn't stored, so both half steps use this step's
+    vec3 newVel = p.vel + newAcc * dt;
+
+    p.pos = newPos;
+
+    if(length(newVel) < 0.001) {p.vel = vec3(0);}
+    else {p.vel = newVel;}
+}
+
+void applyConstraints(inout ParticleState p, float r) {
+    float d = length(p.pos);
+
+    if(d > r){
+        vec3 n = normalize(p.pos);
+        
+        p.pos = n * r;
+        p.vel -= dot(p.vel, n) * n;
+    }
+}
+
+#endif
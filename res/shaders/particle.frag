@@ -4,9 +4,7 @@ out vec4 FragColor;
 
 in vec3 Normal;
 
-uniform vec3 sunDirection;
-uniform vec3 color;
-uniform vec3 ambient;
+#include "common/frame.glsl"
 
 void main(){
     float f = max(dot(-sunDirection, Normal), 0.0);
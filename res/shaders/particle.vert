@@ -1,63 +1,29 @@
 #version 430 core
 
-struct Particle {
-    vec3 pos;
-    vec3 vel;
-    vec3 acc;
-    vec3 newAcc;
-};
-
-layout(std430, binding = 0) buffer Particles {
-    Particle particles[];
-};
+#include "common/particles.glsl"
+#include "common/frame.glsl"
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTex;
 
 out vec3 Normal;
 
-uniform mat4 model;
-uniform mat4 camMatrix;
-uniform float scale; // Uniform for scaling
-
 void main() {
-    uint id = gl_InstanceID;
-    vec3 particlePosition = particles[id].pos;
-
-    // Translation matrix to move particle to the origin
-    mat4 translateToOrigin = mat4(
-        vec4(1.0, 0.0, 0.0, 0.0),
-        vec4(0.0, 1.0, 0.0, 0.0),
-        vec4(0.0, 0.0, 1.0, 0.0),
-        vec4(-particlePosition, 1.0)
-    );
-
-    // Scaling matrix
-    mat4 scaleMatrix = mat4(
-        vec4(scale, 0.0, 0.0, 0.0),
-        vec4(0.0, scale, 0.0, 0.0),
-        vec4(0.0, 0.0, scale, 0.0),
-        vec4(0.0, 0.0, 0.0, 1.0)
-    );
-
-    // Translation matrix to move particle back to its original position
-    mat4 translateBack = mat4(
-        vec4(1.0, 0.0, 0.0, 0.0),
-        vec4(0.0, 1.0, 0.0, 0.0),
-        vec4(0.0, 0.0, 1.0, 0.0),
-        vec4(particlePosition, 1.0)
-    );
-
-    // Combine transformations: Translate to origin -> Scale -> Translate back
-    mat4 particleTransform = translateBack * scaleMatrix * translateToOrigin;
-
-    // Apply the particle-specific transformation and the global model transformation
-    mat4 finalModel = model * particleTransform;
-
-    // Transform normals using the updated model matrix
-    Normal = -normalize(mat3(transpose(inverse(finalModel))) * aNormal);
-
-    // Compute final vertex position
-    gl_Position = camMatrix * finalModel * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    uint id = gl_InstanceID; // One instance per slot
+
+    // Dead slots wait on the free list, park their vertices outside the clip volume
+    if ((loadFlags(id) & PARTICLE_FLAG_ALIVE) == 0u) {
+        Normal = aNormal;
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    vec3 particlePosition = mix(particleRenders[id].prevPos.xyz, loadPosition(id), alpha);
+
+    // A particle is the unit mesh scaled by its radius and moved to its
+    // position, no matrices needed. The scale is uniform, so the mesh normal
+    // needs no inverse transpose either.
+    Normal = -normalize(aNormal);
+
+    gl_Position = camMatrix * vec4(particlePosition + aPos * loadRadius(id), 1.0);
+}
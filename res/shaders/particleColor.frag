@@ -0,0 +1,17 @@
+#version 430 core
+
+out vec4 FragColor;
+
+in vec3 Normal;
+in vec3 Color; // Per instance, see particleInstancedColor.vert
+
+#include "common/frame.glsl"
+
+void main(){
+    float f = max(dot(-sunDirection, Normal), 0.0);
+    vec3 c = ambient + Color * f;
+
+    c = pow(c, vec3(1.0 / 2.2));
+
+    FragColor = vec4(c,1.0);
+}
@@ -0,0 +1,24 @@
+#version 430 core
+
+#include "common/particles.glsl"
+#include "common/frame.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+layout(std430, binding = 26) buffer VisibleSlots {
+    uint visibleSlots[]; // Written by particleCull.comp, one instance each
+};
+
+out vec3 Normal;
+
+void main() {
+    uint id = visibleSlots[gl_InstanceID]; // Only live, visible particles are on the list
+
+    vec3 particlePosition = mix(particleRenders[id].prevPos.xyz, loadPosition(id), alpha);
+
+    // As particle.vert
+    Normal = -normalize(aNormal);
+
+    gl_Position = camMatrix * vec4(particlePosition + aPos * loadRadius(id), 1.0);
+}
@@ -0,0 +1,29 @@
+#version 430 core
+
+#include "common/impostor.glsl"
+
+out vec4 FragColor;
+
+in vec3 ViewPos;
+flat in vec3 Center;
+flat in float Radius;
+
+void main(){
+    vec3 hit;
+    if (!impostorHit(ViewPos, Center, Radius, hit))
+        discard;
+
+    gl_FragDepth = impostorDepth(hit);
+
+    // Outward normal back in world space, where sunDirection is. The view
+    // matrix is a rotation plus a translation, so its transpose inverts it
+    vec3 normal = transpose(mat3(view)) * ((hit - Center) / Radius);
+
+    // particle.frag's shading, whose mesh normals arrive flipped
+    float f = max(dot(sunDirection, normal), 0.0);
+    vec3 c = ambient + color * f;
+
+    c = pow(c, vec3(1.0 / 2.2));
+
+    FragColor = vec4(c,1.0);
+}
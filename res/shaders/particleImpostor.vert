@@ -0,0 +1,28 @@
+#version 430 core
+
+#include "common/particles.glsl"
+#include "common/impostor.glsl"
+
+// No vertex attributes, the quad comes from gl_VertexID, see impostor.glsl
+
+out vec3 ViewPos;
+flat out vec3 Center;
+flat out float Radius;
+
+void main() {
+    uint id = gl_InstanceID; // One instance per slot
+
+    vec3 particlePosition = mix(particleRenders[id].prevPos.xyz, loadPosition(id), alpha);
+    Center = (view * vec4(particlePosition, 1.0)).xyz;
+    Radius = loadRadius(id);
+
+    // Dead slots, and particles the eye is inside, park outside the clip volume
+    if ((loadFlags(id) & PARTICLE_FLAG_ALIVE) == 0u || dot(Center, Center) <= Radius * Radius) {
+        ViewPos = vec3(0.0);
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    ViewPos = impostorCorner(Center, Radius, gl_VertexID);
+    gl_Position = projection * vec4(ViewPos, 1.0);
+}
@@ -0,0 +1,32 @@
+#version 430 core
+
+#include "common/impostor.glsl"
+
+// particleImpostor.vert for the CPU path, reading the ParticleRenderer
+// streams of particleInstanced.vert instead of the GPU pool
+layout (location = 3) in float iX;
+layout (location = 4) in float iY;
+layout (location = 5) in float iZ;
+layout (location = 6) in float iRadius;
+layout (location = 7) in float iPrevX;
+layout (location = 8) in float iPrevY;
+layout (location = 9) in float iPrevZ;
+
+out vec3 ViewPos;
+flat out vec3 Center;
+flat out float Radius;
+
+void main() {
+    vec3 particlePosition = mix(vec3(iPrevX, iPrevY, iPrevZ), vec3(iX, iY, iZ), alpha);
+    Center = (view * vec4(particlePosition, 1.0)).xyz;
+    Radius = iRadius;
+
+    if (dot(Center, Center) <= Radius * Radius) {
+        ViewPos = vec3(0.0);
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    ViewPos = impostorCorner(Center, Radius, gl_VertexID);
+    gl_Position = projection * vec4(ViewPos, 1.0);
+}
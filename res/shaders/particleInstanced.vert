@@ -0,0 +1,26 @@
+#version 430 core
+
+#include "common/frame.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+// One float per stream, straight from the ParticleSystem arrays
+layout (location = 3) in float iX;
+layout (location = 4) in float iY;
+layout (location = 5) in float iZ;
+layout (location = 6) in float iRadius;
+layout (location = 7) in float iPrevX;
+layout (location = 8) in float iPrevY;
+layout (location = 9) in float iPrevZ;
+
+out vec3 Normal;
+
+void main() {
+    vec3 particlePosition = mix(vec3(iPrevX, iPrevY, iPrevZ), vec3(iX, iY, iZ), alpha);
+
+    // Uniform scale, so the mesh normal needs no inverse transpose
+    Normal = -normalize(aNormal);
+
+    gl_Position = camMatrix * vec4(particlePosition + aPos * iRadius, 1.0);
+}
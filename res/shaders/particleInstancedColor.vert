@@ -0,0 +1,29 @@
+#version 430 core
+
+#include "common/frame.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+// As particleInstanced.vert, plus a colour per instance. Kept separate
+// because the extra output costs every vertex, used or not
+layout (location = 3) in float iX;
+layout (location = 4) in float iY;
+layout (location = 5) in float iZ;
+layout (location = 6) in float iRadius;
+layout (location = 7) in float iPrevX;
+layout (location = 8) in float iPrevY;
+layout (location = 9) in float iPrevZ;
+layout (location = 10) in vec3 iColor;
+
+out vec3 Normal;
+out vec3 Color;
+
+void main() {
+    vec3 particlePosition = mix(vec3(iPrevX, iPrevY, iPrevZ), vec3(iX, iY, iZ), alpha);
+
+    Normal = -normalize(aNormal);
+    Color = iColor;
+
+    gl_Position = camMatrix * vec4(particlePosition + aPos * iRadius, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 430 core
+
+#include "common/particles.glsl"
+#include "common/frame.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+// Slot of this instance, from the level's list particleLod.comp wrote
+layout (location = 11) in uint iSlot;
+
+out vec3 Normal;
+
+void main() {
+    uint id = iSlot; // Only live particles are on the lists
+
+    vec3 particlePosition = mix(particleRenders[id].prevPos.xyz, loadPosition(id), alpha);
+
+    // As particle.vert
+    Normal = -normalize(aNormal);
+
+    gl_Position = camMatrix * vec4(particlePosition + aPos * loadRadius(id), 1.0);
+}
@@ -0,0 +1,177 @@
+// Headless simulator: runs the CPU solver (Physx, the same hash grid and
+// integrator particle.comp uses) with no window, GL context or ImGui.
+//
+// Usage: physxgl_sim [options]
+//   --particles N     particles to spawn (default 10000)
+//   --steps N         steps to run (default 1000)
+//   --dt S            step size in seconds (default 1/120)
+//   --substeps N      substeps per step, each re-hashing (default 1)
+//   --threads N       solver threads, 0 = all (default 0)
+//   --radius R        particle radius (default 0.1)
+//   --container R     constraint sphere radius (default 3.1)
+//   --seed N          spawn seed (default 1)
+//   --dump FILE       write the final state as CSV
+//   --dump-every N    also write FILE.<step> every N steps
+//   --profile FILE    write the last 240 steps' solver phases as a Chrome trace
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <string>
+
+#include "physx.h"
+#include "profiler.h"
+
+struct SimSettings
+{
+    int particles = 10000;
+    int steps = 1000;
+    float dt = 1.0f / 120.0f;
+    int subSteps = 1;
+    int threads = 0;
+    float particleRadius = 0.1f;
+    float constraintRadius = 3.1f;
+    unsigned int seed = 1;
+    std::string dumpFile;
+    int dumpEvery = 0;
+    std::string profileFile;
+};
+
+bool parseArgs(int argc, char *argv[], SimSettings &settings)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+            return false;
+        if (value == nullptr)
+        {
+            std::fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+
+        if (std::strcmp(arg, "--particles") == 0)
+            settings.particles = std::atoi(value);
+        else if (std::strcmp(arg, "--steps") == 0)
+            settings.steps = std::atoi(value);
+        else if (std::strcmp(arg, "--dt") == 0)
+            settings.dt = (float)std::atof(value);
+        else if (std::strcmp(arg, "--substeps") == 0)
+            settings.subSteps = std::atoi(value);
+        else if (std::strcmp(arg, "--threads") == 0)
+            settings.threads = std::atoi(value);
+        else if (std::strcmp(arg, "--radius") == 0)
+            settings.particleRadius = (float)std::atof(value);
+        else if (std::strcmp(arg, "--container") == 0)
+            settings.constraintRadius = (float)std::atof(value);
+        else if (std::strcmp(arg, "--seed") == 0)
+            settings.seed = (unsigned int)std::strtoul(value, nullptr, 10);
+        else if (std::strcmp(arg, "--dump") == 0)
+            settings.dumpFile = value;
+        else if (std::strcmp(arg, "--dump-every") == 0)
+            settings.dumpEvery = std::atoi(value);
+        else if (std::strcmp(arg, "--profile") == 0)
+            settings.profileFile = value;
+        else
+        {
+            std::fprintf(stderr, "Unknown option %s\n", arg);
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+bool dumpState(const ParticleSystem &ps, const std::string &filename)
+{
+    FILE *file = std::fopen(filename.c_str(), "w");
+    if (file == nullptr)
+    {
+        std::fprintf(stderr, "Unable to open %s for writing\n", filename.c_str());
+        return false;
+    }
+
+    std::fprintf(file, "x,y,z,vx,vy,vz\n");
+    for (size_t i = 0; i < ps.size(); i++)
+        std::fprintf(file, "%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n", ps.x[i], ps.y[i], ps.z[i], ps.vx[i], ps.vy[i], ps.vz[i]);
+
+    std::fclose(file);
+    return true;
+}
+
+// FNV-1a over the raw bits of the state, equal hashes mean bit-identical runs
+unsigned long long stateHash(const ParticleSystem &ps)
+{
+    unsigned long long h = 14695981039346656037ull;
+    const std::vector<float> *arrays[] = {&ps.x, &ps.y, &ps.z, &ps.vx, &ps.vy, &ps.vz};
+    for (const std::vector<float> *a : arrays)
+    {
+        const unsigned char *bytes = (const unsigned char *)a->data();
+        for (size_t i = 0; i < a->size() * sizeof(float); i++)
+            h = (h ^ bytes[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+int main(int argc, char *argv[])
+{
+    SimSettings settings;
+    if (!parseArgs(argc, argv, settings))
+    {
+        std::fprintf(stderr, "Usage: physxgl_sim [--particles N] [--steps N] [--dt S] [--substeps N] [--threads N]\n"
+                             "                   [--radius R] [--container R] [--seed N] [--dump FILE] [--dump-every N]\n"
+                             "                   [--profile FILE]\n");
+        return EXIT_FAILURE;
+    }
+
+    // Same spawn as the viewer's "Spawn Particle(s)" button, random in the container's bounding box
+    std::mt19937 gen(settings.seed);
+    std::uniform_real_distribution<float> dis(-settings.constraintRadius, settings.constraintRadius);
+
+    ParticleSystem ps;
+    ps.reserve(settings.particles);
+    for (int i = 0; i < settings.particles; i++)
+        ps.spawn(glm::vec3(dis(gen), dis(gen), dis(gen)), glm::vec3(0), settings.particleRadius);
+
+    Physx physx(settings.threads);
+
+    std::printf("particles: %d, steps: %d, dt: %g, substeps: %d, threads: %d\n", settings.particles, settings.steps, settings.dt, settings.subSteps, physx.threadCount());
+
+    // Each step is a profiler frame, zones are only recorded while one is open
+    Profiler &profiler = Profiler::Get();
+    bool profiling = !settings.profileFile.empty();
+
+    double simMs = 0.0;
+    for (int step = 1; step <= settings.steps; step++)
+    {
+        if (profiling)
+            profiler.beginFrame();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        physx.update(ps, settings.particleRadius, settings.dt, 9.81f, settings.constraintRadius, settings.subSteps);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        if (profiling)
+            profiler.endFrame();
+        simMs += elapsed.count();
+
+        if (!settings.dumpFile.empty() && settings.dumpEvery > 0 && step % settings.dumpEvery == 0)
+            dumpState(ps, settings.dumpFile + "." + std::to_string(step));
+    }
+
+    std::printf("total: %.2f ms, %.3f ms/step, %.1f steps/s\n", simMs, simMs / settings.steps, settings.steps * 1000.0 / simMs);
+    std::printf("state hash: %016llx\n", stateHash(ps));
+
+    if (!settings.dumpFile.empty() && !dumpState(ps, settings.dumpFile))
+        return EXIT_FAILURE;
+
+    if (profiling && !profiler.writeChromeTrace(settings.profileFile))
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
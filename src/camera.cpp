@@ -19,8 +19,8 @@ void Camera::updateMatrix(float FOVdeg, float nearPlane, float farPlane)
 void Camera::Matrix(Shader &shader, const char *uniform)
 {
 
-    glUniformMatrix4fv(glGetUniformLocation(shader.ID, uniform), 1, GL_FALSE, glm::value_ptr(cameraMatrix));
-    glUniform3f(glGetUniformLocation(shader.ID, "viewPos"), Position.x, Position.y, Position.z);
+    glUniformMatrix4fv(shader.uniform(uniform), 1, GL_FALSE, glm::value_ptr(cameraMatrix));
+    glUniform3f(shader.uniform("viewPos"), Position.x, Position.y, Position.z);
 }
 
 void Camera::Inputs(GLFWwindow *window, float pivotDist)
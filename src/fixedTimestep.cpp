@@ -0,0 +1,35 @@
+#include "fixedTimestep.h"
+
+FixedTimestep::FixedTimestep(float step, int maxStepsPerFrame)
+{
+    FixedTimestep::step = step;
+    FixedTimestep::maxStepsPerFrame = maxStepsPerFrame;
+}
+
+int FixedTimestep::advance(float frameDt)
+{
+    accumulator += frameDt;
+
+    int steps = (int)(accumulator / step);
+    if (steps > maxStepsPerFrame)
+    {
+        // Drop the time we can't catch up on instead of carrying it forward
+        steps = maxStepsPerFrame;
+        accumulator = (double)steps * step;
+    }
+    accumulator -= (double)steps * step;
+
+    totalSteps += steps;
+    return steps;
+}
+
+float FixedTimestep::alpha() const
+{
+    return (float)(accumulator / step);
+}
+
+void FixedTimestep::reset()
+{
+    accumulator = 0.0;
+    totalSteps = 0;
+}
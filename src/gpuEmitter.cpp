@@ -0,0 +1,54 @@
+#include "gpuEmitter.h"
+
+#include <cmath>
+
+GpuEmitter::GpuEmitter()
+    : emitShader("res/shaders/particleEmit.comp")
+{
+}
+
+void GpuEmitter::emit(GpuParticlePool &pool, float dt)
+{
+    if (!enabled || rate <= 0.0f)
+        return;
+
+    accumulator += rate * dt;
+    int emitCount = (int)accumulator;
+    accumulator -= emitCount;
+    if (emitCount == 0)
+        return;
+
+    // The pool can't see the GPU's slotCount, so the emitter reserves what it
+    // can have alive at once, plus a step's worth while freed slots wait for
+    // the next life pass. Only ever grows, slots are never handed back.
+    int steadyState = (int)std::ceil(rate * (lifetime + lifetimeSpread)) + 2 * emitCount;
+    if (steadyState > reserved)
+    {
+        pool.reserveSlots(steadyState - reserved);
+        reserved = steadyState;
+    }
+
+    emitShader.use();
+    emitShader.setInt("emitCount", emitCount);
+    emitShader.setUInt("seed", seed++);
+    emitShader.setInt("shape", (int)shape);
+    emitShader.setVec3("center", position);
+    emitShader.setFloat("size", size);
+    float axisLength = glm::length(axis);
+    emitShader.setVec3("axis", axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 1.0f, 0.0f));
+    emitShader.setVec3("velocity", velocity);
+    emitShader.setFloat("velocitySpread", velocitySpread);
+    emitShader.setFloat("radialSpeed", radialSpeed);
+    emitShader.setFloat("lifetime", lifetime);
+    emitShader.setFloat("lifetimeSpread", lifetimeSpread);
+    emitShader.setFloat("radius", particleRadius);
+    glDispatchCompute((emitCount + 255) / 256, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    pool.updateArgs();
+}
+
+void GpuEmitter::Delete()
+{
+    glDeleteProgram(emitShader.ID);
+}
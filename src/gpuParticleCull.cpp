@@ -0,0 +1,170 @@
+#include "gpuParticleCull.h"
+
+#include <algorithm>
+#include <cstddef>
+
+GpuParticleCull::GpuParticleCull()
+    : cullShader("res/shaders/particleCull.comp"),
+      hiZShader("res/shaders/particleHiZ.comp")
+{
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &visibleBuffer);
+    glGenBuffers(1, &statsBuffer);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(gpu::DrawCommand), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, statsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(gpu::CullStats), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuParticleCull::reserve(int n)
+{
+    if (n <= capacity)
+        return;
+
+    // Rebuilt every frame, nothing to keep
+    growShaderBuffer(visibleBuffer, 0, sizeof(GLuint) * n);
+    capacity = n;
+}
+
+void GpuParticleCull::beginFrame()
+{
+    frame++;
+}
+
+void GpuParticleCull::prepare(ComputeShader &shader, const glm::mat4 &cameraMatrix)
+{
+    gpu::CullStats stats = {};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, statsBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(stats), &stats);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 24, statsBuffer); // Binding = 24
+
+    // Rows of the camera matrix give the six clip planes (Gribb and Hartmann),
+    // normalised so a plane's distance compares with the radius
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; r++)
+        rows[r] = glm::vec4(cameraMatrix[0][r], cameraMatrix[1][r], cameraMatrix[2][r], cameraMatrix[3][r]);
+
+    glm::vec4 planes[6];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        planes[2 * axis] = rows[3] + rows[axis];
+        planes[2 * axis + 1] = rows[3] - rows[axis];
+    }
+    for (glm::vec4 &plane : planes)
+        plane = plane * (1.0f / glm::length(glm::vec3(plane.x, plane.y, plane.z)));
+
+    shader.use();
+    shader.setMat4("cullMatrix", cameraMatrix);
+    glUniform4fv(shader.uniform("frustumPlanes"), 6, &planes[0][0]);
+    shader.setBool("frustumCull", frustum);
+
+    // A pyramid older than last frame belongs to another view
+    shader.setBool("occlusionCull", occlusion && hiZFrame == frame - 1);
+    shader.setInt("hiZ", 0);
+    glUniform2i(shader.uniform("hiZSize"), hiZWidth, hiZHeight);
+    shader.setInt("hiZLevels", hiZLevels);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, hiZTexture);
+}
+
+void GpuParticleCull::cull(GpuParticlePool &pool, const glm::mat4 &cameraMatrix, float alpha)
+{
+    reserve(pool.capacity);
+
+    // The pool's mesh command with no instances yet, the pass counts the visible ones
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_COPY_READ_BUFFER, pool.argsBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, commandBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offsetof(gpu::IndirectArgs, indexCount), 0, sizeof(gpu::DrawCommand));
+    GLuint zero = 0;
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offsetof(gpu::DrawCommand, instanceCount), sizeof(GLuint), &zero);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, pool.buffer);       // Binding = 0
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 25, commandBuffer);    // Binding = 25
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 26, visibleBuffer);    // Binding = 26
+
+    prepare(cullShader, cameraMatrix);
+    cullShader.setFloat("alpha", alpha);
+
+    pool.dispatch(256);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void GpuParticleCull::drawElements()
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 26, visibleBuffer); // Binding = 26
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GpuParticleCull::resizeHiZ(int width, int height)
+{
+    if (width == hiZWidth && height == hiZHeight)
+        return;
+
+    glDeleteTextures(1, &depthTexture);
+    glDeleteTextures(1, &hiZTexture);
+    hiZWidth = width;
+    hiZHeight = height;
+    hiZLevels = 1;
+    while ((std::max(width, height) >> hiZLevels) > 0)
+        hiZLevels++;
+
+    glGenTextures(1, &depthTexture);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenTextures(1, &hiZTexture);
+    glBindTexture(GL_TEXTURE_2D, hiZTexture);
+    glTexStorage2D(GL_TEXTURE_2D, hiZLevels, GL_R32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GpuParticleCull::updateHiZ(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return;
+    resizeHiZ(width, height);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+    hiZShader.use();
+    hiZShader.setInt("depthBuffer", 0);
+    for (int level = 0; level < hiZLevels; level++)
+    {
+        int w = std::max(width >> level, 1);
+        int h = std::max(height >> level, 1);
+
+        hiZShader.setInt("level", level);
+        glBindImageTexture(0, hiZTexture, std::max(level - 1, 0), GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, hiZTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute((w + 7) / 8, (h + 7) / 8, 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    hiZFrame = frame;
+}
+
+void GpuParticleCull::Delete()
+{
+    GLuint buffers[] = {commandBuffer, visibleBuffer, statsBuffer};
+    glDeleteBuffers(3, buffers);
+    glDeleteTextures(1, &depthTexture);
+    glDeleteTextures(1, &hiZTexture);
+    glDeleteProgram(cullShader.ID);
+    glDeleteProgram(hiZShader.ID);
+}
@@ -0,0 +1,171 @@
+#include "gpuParticleLod.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+// Unit icosphere subdivided `subdivisions` times, positions double as normals
+static void buildIcosphere(int subdivisions, std::vector<glm::vec3> &vertices, std::vector<GLuint> &indices)
+{
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    vertices = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+                {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+                {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+    for (glm::vec3 &v : vertices)
+        v = glm::normalize(v);
+
+    indices = {0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+               1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+               3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+               4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1};
+
+    for (int s = 0; s < subdivisions; s++)
+    {
+        // Edges shared by two triangles get one midpoint between them
+        std::map<std::pair<GLuint, GLuint>, GLuint> midpoints;
+        auto midpoint = [&](GLuint a, GLuint b)
+        {
+            std::pair<GLuint, GLuint> edge(std::min(a, b), std::max(a, b));
+            auto found = midpoints.find(edge);
+            if (found != midpoints.end())
+                return found->second;
+
+            vertices.push_back(glm::normalize(vertices[a] + vertices[b]));
+            GLuint m = (GLuint)vertices.size() - 1;
+            midpoints[edge] = m;
+            return m;
+        };
+
+        std::vector<GLuint> subdivided;
+        subdivided.reserve(indices.size() * 4);
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            GLuint a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            GLuint ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            GLuint triangles[] = {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca};
+            subdivided.insert(subdivided.end(), triangles, triangles + 12);
+        }
+        indices.swap(subdivided);
+    }
+}
+
+GpuParticleLod::GpuParticleLod()
+    : lodShader("res/shaders/particleLod.comp")
+{
+    // Every level in one vertex and one index buffer, told apart by baseVertex and firstIndex
+    std::vector<glm::vec3> vertices;
+    std::vector<GLuint> indices;
+    for (int level = 0; level < levels; level++)
+    {
+        std::vector<glm::vec3> levelVertices;
+        std::vector<GLuint> levelIndices;
+        buildIcosphere(level, levelVertices, levelIndices);
+
+        levelBaseVertex[level] = (GLint)vertices.size();
+        levelFirstIndex[level] = (GLuint)indices.size();
+        levelIndexCounts[level] = (GLuint)levelIndices.size();
+        vertices.insert(vertices.end(), levelVertices.begin(), levelVertices.end());
+        indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+    }
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &instanceBuffer);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+
+    // Position and normal are the same vector on a unit sphere
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, levels * sizeof(gpu::DrawCommand), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GpuParticleLod::reserve(int n)
+{
+    if (n <= capacity)
+        return;
+    capacity = n;
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)levels * capacity * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+
+    // Each instance reads its slot from the list; the commands' baseInstance picks the level's list
+    glBindVertexArray(VAO);
+    glVertexAttribIPointer(11, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void *)0);
+    glVertexAttribDivisor(11, 1);
+    glEnableVertexAttribArray(11);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GpuParticleLod::bucket(GpuParticlePool &pool, const glm::mat4 &cameraMatrix, float pixelScale, float alpha, GpuParticleCull *cull)
+{
+    reserve(pool.capacity);
+
+    // Instance counts start from zero, the pass counts them afresh
+    gpu::DrawCommand commands[levels];
+    for (int level = 0; level < levels; level++)
+        commands[level] = {levelIndexCounts[level], 0, levelFirstIndex[level], levelBaseVertex[level], (GLuint)(level * capacity)};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(commands), commands);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, pool.buffer);        // Binding = 0
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 22, commandBuffer);     // Binding = 22
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 23, instanceBuffer);    // Binding = 23
+
+    if (cull != nullptr)
+    {
+        cull->prepare(lodShader, cameraMatrix);
+    }
+    else
+    {
+        lodShader.use();
+        lodShader.setBool("frustumCull", false);
+        lodShader.setBool("occlusionCull", false);
+    }
+
+    lodShader.use();
+    lodShader.setMat4("camMatrix", cameraMatrix);
+    lodShader.setFloat("alpha", alpha);
+    lodShader.setFloat("pixelScale", pixelScale);
+    lodShader.setUInt("levelStride", (unsigned int)capacity);
+    glUniform1fv(lodShader.uniform("lodPixels"), levels - 1, lodPixels);
+
+    pool.dispatch(256);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void GpuParticleLod::draw()
+{
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, levels, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void GpuParticleLod::Delete()
+{
+    glDeleteVertexArrays(1, &VAO);
+    GLuint buffers[] = {VBO, EBO, commandBuffer, instanceBuffer};
+    glDeleteBuffers(4, buffers);
+    glDeleteProgram(lodShader.ID);
+}
@@ -0,0 +1,208 @@
+#include "gpuParticlePool.h"
+
+#include <algorithm>
+#include <cstddef>
+
+GpuParticlePool::GpuParticlePool(int initialCapacity)
+    : appendShader("res/shaders/particleAppend.comp"),
+      argsShader("res/shaders/particleArgs.comp"),
+      lifeShader("res/shaders/particleLife.comp")
+{
+    GLuint *buffers[] = {&buffer, &renderBuffer, &idsBuffer, &lifeBuffer, &freeBuffer, &activeBuffer, &counterBuffer, &argsBuffer, &stagedBuffer, &stagedRenderBuffer, &arraysArgsBuffer};
+    for (GLuint *b : buffers)
+        glGenBuffers(1, b);
+
+    gpu::ParticleCounters counters = {};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(counters), &counters, GL_DYNAMIC_DRAW);
+
+    gpu::IndirectArgs args = {};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, argsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(args), &args, GL_DYNAMIC_DRAW);
+
+    GLuint arraysArgs[4] = {}; // count, instanceCount, first, baseInstance
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, arraysArgsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(arraysArgs), arraysArgs, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, counterBuffer); // Binding = 12
+
+    reserve(initialCapacity);
+    updateArgs();
+}
+
+void growShaderBuffer(GLuint &buffer, GLsizeiptr keepSize, GLsizeiptr newSize)
+{
+    GLuint grown;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_DYNAMIC_DRAW);
+
+    if (keepSize > 0)
+    {
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT); // Let compute writes land before the copy
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepSize);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &buffer);
+    buffer = grown;
+}
+
+void GpuParticlePool::reserve(int n)
+{
+    if (n <= capacity)
+        return;
+
+    // The live particles only exist on the GPU, so they are copied across without a readback
+    int newCapacity = std::max(n, 2 * capacity);
+    growShaderBuffer(buffer, sizeof(gpu::Particle) * count, sizeof(gpu::Particle) * newCapacity);
+    growShaderBuffer(renderBuffer, sizeof(gpu::ParticleRender) * count, sizeof(gpu::ParticleRender) * newCapacity);
+    growShaderBuffer(idsBuffer, sizeof(GLuint) * count, sizeof(GLuint) * newCapacity);
+    growShaderBuffer(lifeBuffer, sizeof(float) * count, sizeof(float) * newCapacity);
+    growShaderBuffer(freeBuffer, 0, sizeof(GLuint) * newCapacity); // Rebuilt every step
+    growShaderBuffer(activeBuffer, 0, sizeof(GLuint) * newCapacity);
+    capacity = newCapacity;
+
+    GLuint newCapacityU = newCapacity;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, offsetof(gpu::ParticleCounters, capacity), sizeof(GLuint), &newCapacityU);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);        // Binding = 0
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, idsBuffer);     // Binding = 6
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, renderBuffer); // Binding = 10
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 16, lifeBuffer);   // Binding = 16
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 18, freeBuffer);   // Binding = 18
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 21, activeBuffer); // Binding = 21
+}
+
+void GpuParticlePool::append(const gpu::Particle *particles, const gpu::ParticleRender *renders, int n)
+{
+    if (n <= 0)
+        return;
+
+    reserve(count + n);
+
+    // Staging is orphaned every time, the previous append may still be reading it
+    stagedCapacity = std::max(stagedCapacity, n);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, stagedBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(gpu::Particle) * stagedCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(gpu::Particle) * n, particles);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, stagedRenderBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(gpu::ParticleRender) * stagedCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(gpu::ParticleRender) * n, renders);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, stagedBuffer);       // Binding = 13
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, stagedRenderBuffer); // Binding = 14
+
+    appendShader.use();
+    appendShader.setInt("stagedCount", n);
+    glDispatchCompute((n + 255) / 256, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    count += n;
+    updateArgs();
+}
+
+void GpuParticlePool::reserveSlots(int n)
+{
+    reserve(count + n);
+    count += n;
+}
+
+void GpuParticlePool::updateLifetimes(float dt)
+{
+    // freeCount and aliveCount start from zero, the pass counts them afresh
+    GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, offsetof(gpu::ParticleCounters, freeCount), 2 * sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    lifeShader.use();
+    lifeShader.setFloat("dt", dt);
+    dispatch(256);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuParticlePool::updateArgs()
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 15, argsBuffer); // Binding = 15
+
+    argsShader.use();
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
+
+void GpuParticlePool::setIndexCount(GLuint indexCount)
+{
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, argsBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, offsetof(gpu::IndirectArgs, indexCount), sizeof(GLuint), &indexCount);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuParticlePool::dispatch(int localSize)
+{
+    GLintptr offset = localSize == 128 ? offsetof(gpu::IndirectArgs, particleGroups) : offsetof(gpu::IndirectArgs, bufferGroups);
+
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, argsBuffer);
+    glDispatchComputeIndirect(offset);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+}
+
+void GpuParticlePool::dispatchActive(int localSize)
+{
+    GLintptr offset = localSize == 128 ? offsetof(gpu::IndirectArgs, activeParticleGroups) : offsetof(gpu::IndirectArgs, activeBufferGroups);
+
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, argsBuffer);
+    glDispatchComputeIndirect(offset);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+}
+
+void GpuParticlePool::drawElements()
+{
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, argsBuffer);
+    glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void *)offsetof(gpu::IndirectArgs, indexCount));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GpuParticlePool::drawArrays(GLenum mode, GLuint vertexCount)
+{
+    // The instance count only exists on the GPU, copy it across rather than read it back
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_COPY_READ_BUFFER, argsBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arraysArgsBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(GLuint), &vertexCount);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offsetof(gpu::IndirectArgs, instanceCount), sizeof(GLuint), sizeof(GLuint));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, arraysArgsBuffer);
+    glDrawArraysIndirect(mode, nullptr);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GpuParticlePool::clear()
+{
+    count = 0;
+
+    GLuint zero[2] = {0, 0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zero), zero); // slotCount, spawnedCount
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, offsetof(gpu::ParticleCounters, freeCount), sizeof(zero), zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    updateArgs();
+}
+
+void GpuParticlePool::Delete()
+{
+    GLuint buffers[] = {buffer, renderBuffer, idsBuffer, lifeBuffer, freeBuffer, activeBuffer, counterBuffer, argsBuffer, stagedBuffer, stagedRenderBuffer, arraysArgsBuffer};
+    glDeleteBuffers(11, buffers);
+    glDeleteProgram(appendShader.ID);
+    glDeleteProgram(argsShader.ID);
+    glDeleteProgram(lifeShader.ID);
+}
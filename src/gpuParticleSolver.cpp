@@ -0,0 +1,204 @@
+#include "gpuParticleSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+GpuParticleSolver::GpuParticleSolver()
+    : directShader("res/shaders/particle.comp"),
+      integrateShader("res/shaders/particleIntegrate.comp"),
+      jacobiShader("res/shaders/particleJacobi.comp"),
+      colouredShader("res/shaders/particleColoured.comp"),
+      xpbdVelocityShader("res/shaders/particleXpbdVelocity.comp"),
+      sleepShader("res/shaders/particleSleep.comp")
+{
+    glGenBuffers(1, &snapshotBuffer);
+    glGenBuffers(1, &startBuffer);
+}
+
+void GpuParticleSolver::setUniforms(ComputeShader &shader, GpuSpatialHash &hash, float subDt, int subStep)
+{
+    shader.use();
+    hash.setUniforms(shader);
+    shader.setFloat("dt", subDt);
+    shader.setInt("subStep", subStep);
+    shader.setFloat("g", gravity);
+    shader.setFloat("cr", containerRadius);
+    shader.setFloat("radius", particleRadius);
+    shader.setFloat("compliance", compliance);
+    shader.setFloat("damping", damping);
+    shader.setUInt("sleepSteps", sleepSteps);
+    shader.setFloat("wakeEnergy", wakeEnergy);
+}
+
+void GpuParticleSolver::updateSleep(GpuParticlePool &pool, float dt)
+{
+    sleepSteps = sleeping ? (GLuint)std::clamp((int)std::ceil(sleepTime / dt), 1, (int)PARTICLE_REST_MAX) : 0;
+
+    // The pass lists the awake particles afresh
+    GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, pool.counterBuffer);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, offsetof(gpu::ParticleCounters, activeCount), sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    sleepShader.use();
+    sleepShader.setUInt("sleepSteps", sleepSteps);
+    sleepShader.setFloat("sleepDistance", sleepSpeed * dt);
+    pool.dispatch(256);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Sizes the dispatches over the list
+    pool.updateArgs();
+}
+
+void GpuParticleSolver::step(GpuParticlePool &pool, GpuSpatialHash &hash, float dt, GpuParticleSort *sort)
+{
+    subSteps = std::max(subSteps, 1);
+    substepsPerHash = std::clamp(substepsPerHash, 1, subSteps);
+    iterations = std::max(iterations, 1);
+
+    // Sorting moves particles to other slots, so it goes before the active
+    // list is built. Before integration too, it would leave the Xpbd start
+    // positions in the old order.
+    if (sort != nullptr)
+    {
+        hash.build(pool);
+        sort->sort(pool);
+    }
+
+    updateSleep(pool, dt);
+
+    if (mode == SolverMode::Direct)
+        stepDirect(pool, hash, dt, sort != nullptr);
+    else
+        stepRaceFree(pool, hash, dt);
+}
+
+void GpuParticleSolver::stepDirect(GpuParticlePool &pool, GpuSpatialHash &hash, float dt, bool hashBuilt)
+{
+    // Nothing outruns a fall across the whole container, so that bounds how
+    // far two particles can close in on each other between hash builds
+    float speedBound = std::sqrt(2.0f * gravity * 2.0f * containerRadius);
+    float subDt = dt / subSteps;
+
+    // Every dispatch needs a hash of where the particles are now, which
+    // takes a global sync, so each group of substeps gets its own build
+    for (int sub = 0; sub < subSteps; sub += substepsPerHash)
+    {
+        int innerSteps = std::min(substepsPerHash, subSteps - sub);
+
+        // Sorting leaves the hash it was built from valid
+        if (sub > 0 || !hashBuilt)
+            hash.build(pool);
+
+        setUniforms(directShader, hash, subDt, sub);
+        directShader.setInt("innerSteps", innerSteps);
+        directShader.setFloat("queryMargin", innerSteps > 1 ? 2.0f * speedBound * innerSteps * subDt : 0.0f);
+        pool.dispatchActive(128); // Sized on the GPU from the awake count
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+}
+
+void GpuParticleSolver::stepRaceFree(GpuParticlePool &pool, GpuSpatialHash &hash, float dt)
+{
+    float subDt = dt / subSteps;
+    bool xpbd = mode == SolverMode::Xpbd;
+
+    if (xpbd)
+    {
+        if (startCapacity < pool.capacity)
+        {
+            startCapacity = pool.capacity;
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, startBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) * startCapacity, nullptr, GL_DYNAMIC_COPY);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 20, startBuffer); // Binding = 20
+    }
+
+    for (int sub = 0; sub < subSteps; sub++)
+    {
+        // 1. Move every particle on its own
+        setUniforms(integrateShader, hash, subDt, sub);
+        integrateShader.setBool("xpbd", xpbd);
+        pool.dispatchActive(256);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        // 2. Hash the new positions, in a fixed order within every bucket
+        hash.build(pool);
+        hash.sortBuckets();
+
+        // 3. Resolve contacts race-free. Later iterations query the same
+        // hash, the particles only moved a little.
+        if (mode == SolverMode::Jacobi)
+        {
+            for (int it = 0; it < iterations; it++)
+            {
+                takeSnapshot(pool);
+                setUniforms(jacobiShader, hash, subDt, sub);
+                jacobiShader.setFloat("relaxation", relaxation);
+                pool.dispatchActive(128);
+                glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            }
+        }
+        else
+        {
+            // Cells come from the hashed positions for the whole sweep
+            takeSnapshot(pool);
+            setUniforms(colouredShader, hash, subDt, sub);
+            colouredShader.setBool("xpbd", xpbd);
+            for (int it = 0; it < iterations; it++)
+            {
+                for (int colour = 0; colour < 27; colour++)
+                {
+                    colouredShader.setInt("colour", colour);
+                    glDispatchCompute((hash.tableSize + 127) / 128, 1, 1);
+                    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+                }
+            }
+        }
+
+        // 4. Xpbd velocities from the corrected positions
+        if (xpbd)
+        {
+            setUniforms(xpbdVelocityShader, hash, subDt, sub);
+            pool.dispatchActive(256);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+    }
+}
+
+void GpuParticleSolver::takeSnapshot(GpuParticlePool &pool)
+{
+    if (snapshotCapacity < pool.capacity)
+    {
+        snapshotCapacity = pool.capacity;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, snapshotBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(gpu::Particle) * snapshotCapacity, nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    if (pool.count > 0)
+    {
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_COPY_READ_BUFFER, pool.buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, snapshotBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(gpu::Particle) * pool.count);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 19, snapshotBuffer); // Binding = 19
+}
+
+void GpuParticleSolver::Delete()
+{
+    glDeleteBuffers(1, &snapshotBuffer);
+    glDeleteBuffers(1, &startBuffer);
+    glDeleteProgram(directShader.ID);
+    glDeleteProgram(integrateShader.ID);
+    glDeleteProgram(jacobiShader.ID);
+    glDeleteProgram(colouredShader.ID);
+    glDeleteProgram(xpbdVelocityShader.ID);
+    glDeleteProgram(sleepShader.ID);
+}
@@ -0,0 +1,72 @@
+#include "gpuParticleSort.h"
+
+#include <algorithm>
+#include <cstddef>
+
+GpuParticleSort::GpuParticleSort()
+    : sortShader("res/shaders/particleSort.comp")
+{
+    glGenBuffers(1, &sortedBuffer);
+    glGenBuffers(1, &sortedRenderBuffer);
+    glGenBuffers(1, &sortedIdsBuffer);
+    glGenBuffers(1, &sortedLifeBuffer);
+}
+
+void GpuParticleSort::sort(GpuParticlePool &pool)
+{
+    if (pool.count == 0)
+        return;
+
+    // The scratch copies follow the pool's capacity, the contents don't need keeping
+    if (sortedCapacity != pool.capacity)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, sortedBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(gpu::Particle) * pool.capacity, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, sortedRenderBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(gpu::ParticleRender) * pool.capacity, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, sortedIdsBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * pool.capacity, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, sortedLifeBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * pool.capacity, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        sortedCapacity = pool.capacity;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, sortedBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, sortedIdsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, sortedRenderBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 17, sortedLifeBuffer);
+
+    sortShader.use();
+    pool.dispatch(256);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Ping-pong: the sorted copies become the pool's live buffers. Slots past
+    // the live count were not copied, nothing reads them before an append.
+    std::swap(pool.buffer, sortedBuffer);
+    std::swap(pool.renderBuffer, sortedRenderBuffer);
+    std::swap(pool.idsBuffer, sortedIdsBuffer);
+    std::swap(pool.lifeBuffer, sortedLifeBuffer);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, pool.buffer);        // Binding = 0
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, pool.idsBuffer);     // Binding = 6
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, pool.renderBuffer); // Binding = 10
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 16, pool.lifeBuffer);   // Binding = 16
+
+    // The free list names slots from before the sort, which may hold live
+    // particles now. Empty it; new particles go past slotCount until the next
+    // life pass lists the dead slots the sort packed at the back.
+    GLint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, pool.counterBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, offsetof(gpu::ParticleCounters, freeCount), sizeof(zero), &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuParticleSort::Delete()
+{
+    glDeleteBuffers(1, &sortedBuffer);
+    glDeleteBuffers(1, &sortedRenderBuffer);
+    glDeleteBuffers(1, &sortedIdsBuffer);
+    glDeleteBuffers(1, &sortedLifeBuffer);
+    glDeleteProgram(sortShader.ID);
+}
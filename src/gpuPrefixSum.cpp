@@ -0,0 +1,64 @@
+#include "gpuPrefixSum.h"
+
+GpuPrefixSum::GpuPrefixSum()
+    : scanShader("res/shaders/prefixSum.comp"),
+      addShader("res/shaders/prefixSumAdd.comp")
+{
+}
+
+void GpuPrefixSum::scan(GLuint buffer, int count)
+{
+    if (count > 0)
+        scanLevel(buffer, count, 0);
+}
+
+void GpuPrefixSum::scanLevel(GLuint buffer, int count, size_t level)
+{
+    int numBlocks = (count + blockSize - 1) / blockSize;
+
+    if (levelBuffers.size() <= level)
+    {
+        GLuint sums;
+        glGenBuffers(1, &sums);
+        levelBuffers.push_back(sums);
+        levelCapacity.push_back(0);
+    }
+    if (levelCapacity[level] < numBlocks)
+    {
+        levelCapacity[level] = numBlocks;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, levelBuffers[level]);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * numBlocks, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, levelBuffers[level]);
+
+    scanShader.use();
+    scanShader.setInt("count", count);
+    glDispatchCompute(numBlocks, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    if (numBlocks == 1)
+        return;
+
+    // Scan the block totals, then fold them back into this level
+    scanLevel(levelBuffers[level], numBlocks, level + 1);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, levelBuffers[level]);
+
+    addShader.use();
+    addShader.setInt("count", count);
+    glDispatchCompute((count + 255) / 256, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuPrefixSum::Delete()
+{
+    glDeleteBuffers((GLsizei)levelBuffers.size(), levelBuffers.data());
+    levelBuffers.clear();
+    levelCapacity.clear();
+    glDeleteProgram(scanShader.ID);
+    glDeleteProgram(addShader.ID);
+}
@@ -0,0 +1,120 @@
+#include "gpuProfiler.h"
+
+#include <algorithm>
+
+GpuProfiler::GpuProfiler(int framesInFlight)
+    : frames(std::max(framesInFlight, 1))
+{
+}
+
+void GpuProfiler::beginFrame(Profiler &profiler)
+{
+    current = -1;
+    if (!profiler.recording)
+        return;
+
+    Frame &f = frames[next];
+
+    // The GPU is more than framesInFlight frames behind, only now is it worth waiting
+    if (f.pending)
+        resolve(f, profiler, true);
+
+    f.frame = profiler.currentFrame();
+    f.zones.clear();
+    f.usedQueries = 0;
+    f.syncMs = profiler.now() - profiler.frameStartMs();
+    glGetInteger64v(GL_TIMESTAMP, &f.gpuSyncNs);
+
+    current = next;
+    next = (next + 1) % (int)frames.size();
+    depth = 0;
+}
+
+void GpuProfiler::endFrame()
+{
+    if (current < 0)
+        return;
+
+    frames[current].pending = true;
+    current = -1;
+}
+
+int GpuProfiler::beginZone(const char *name)
+{
+    if (current < 0)
+        return -1;
+
+    Frame &f = frames[current];
+    GLuint startQuery = acquireQuery(f);
+    GLuint endQuery = acquireQuery(f);
+    glQueryCounter(startQuery, GL_TIMESTAMP);
+
+    f.zones.push_back({name, depth++, startQuery, endQuery});
+    return (int)f.zones.size() - 1;
+}
+
+void GpuProfiler::endZone(int zone)
+{
+    if (zone < 0 || current < 0)
+        return;
+
+    depth--;
+    glQueryCounter(frames[current].zones[zone].endQuery, GL_TIMESTAMP);
+}
+
+void GpuProfiler::collect(Profiler &profiler)
+{
+    // Oldest first, results become available in submission order
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        Frame &f = frames[(next + i) % frames.size()];
+        if (f.pending && !resolve(f, profiler, false))
+            break;
+    }
+}
+
+bool GpuProfiler::resolve(Frame &f, Profiler &profiler, bool wait)
+{
+    if (!f.zones.empty() && !wait)
+    {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(f.zones.back().endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+    }
+
+    for (const Zone &zone : f.zones)
+    {
+        GLuint64 start, end;
+        glGetQueryObjectui64v(zone.startQuery, GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+
+        double startMs = f.syncMs + ((GLint64)start - f.gpuSyncNs) / 1.0e6;
+        profiler.addZone(f.frame, {zone.name, ProfileLane::Gpu, zone.depth, startMs, (end - start) / 1.0e6});
+    }
+
+    f.pending = false;
+    return true;
+}
+
+GLuint GpuProfiler::acquireQuery(Frame &f)
+{
+    if (f.usedQueries == (int)f.queries.size())
+    {
+        GLuint query;
+        glGenQueries(1, &query);
+        f.queries.push_back(query);
+    }
+    return f.queries[f.usedQueries++];
+}
+
+void GpuProfiler::Delete()
+{
+    for (Frame &f : frames)
+    {
+        if (!f.queries.empty())
+            glDeleteQueries((GLsizei)f.queries.size(), f.queries.data());
+        f = Frame();
+    }
+    current = -1;
+}
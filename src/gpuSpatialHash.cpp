@@ -0,0 +1,96 @@
+#include "gpuSpatialHash.h"
+
+#include <algorithm>
+
+GpuSpatialHash::GpuSpatialHash(float spacing)
+    : clearShader("res/shaders/hashClear.comp"),
+      countShader("res/shaders/hashCount.comp"),
+      scatterShader("res/shaders/hashScatter.comp"),
+      sortBucketsShader("res/shaders/hashSortBuckets.comp")
+{
+    GpuSpatialHash::spacing = spacing;
+
+    glGenBuffers(1, &cellCountBuffer);
+    glGenBuffers(1, &particleMapBuffer);
+    glGenBuffers(1, &cellIdsBuffer);
+
+    resize(512);
+}
+
+void GpuSpatialHash::resize(int numObjs)
+{
+    if (numObjs > maxNumObjs)
+    {
+        // Grow geometrically so spawning in small batches doesn't reallocate every time
+        maxNumObjs = std::max(numObjs, 2 * maxNumObjs);
+        tableSize = 2 * maxNumObjs;
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellCountBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * (tableSize + 1), nullptr, GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, particleMapBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * maxNumObjs, nullptr, GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, cellIdsBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * maxNumObjs, nullptr, GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cellCountBuffer);   // Binding = 1
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, particleMapBuffer); // Binding = 2
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, cellIdsBuffer);     // Binding = 3
+}
+
+void GpuSpatialHash::setUniforms(ComputeShader &shader)
+{
+    shader.setFloat("hash.spacing", spacing);
+    shader.setInt("hash.maxObjs", maxNumObjs);
+    shader.setInt("hash.tableSize", tableSize);
+}
+
+void GpuSpatialHash::build(GpuParticlePool &pool)
+{
+    resize(pool.capacity);
+
+    // 1. Zero the counts, including the sentinel at tableSize
+    clearShader.use();
+    setUniforms(clearShader);
+    glDispatchCompute((tableSize + 1 + 255) / 256, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 2. Count particles per bucket
+    countShader.use();
+    setUniforms(countShader);
+    pool.dispatch(256);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 3. Counts -> bucket ends, the sentinel ends up holding the live count
+    prefixSum.scan(cellCountBuffer, tableSize + 1);
+
+    // 4. Scatter particle ids, which turns bucket ends into bucket starts
+    scatterShader.use();
+    setUniforms(scatterShader);
+    pool.dispatch(256);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuSpatialHash::sortBuckets()
+{
+    sortBucketsShader.use();
+    setUniforms(sortBucketsShader);
+    glDispatchCompute((tableSize + 255) / 256, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuSpatialHash::Delete()
+{
+    glDeleteBuffers(1, &cellCountBuffer);
+    glDeleteBuffers(1, &particleMapBuffer);
+    glDeleteBuffers(1, &cellIdsBuffer);
+    glDeleteProgram(clearShader.ID);
+    glDeleteProgram(countShader.ID);
+    glDeleteProgram(scatterShader.ID);
+    glDeleteProgram(sortBucketsShader.ID);
+    prefixSum.Delete();
+}
@@ -0,0 +1,147 @@
+#include "jobSystem.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(int numThreads)
+{
+    start(numThreads);
+}
+
+JobSystem::~JobSystem()
+{
+    stop();
+}
+
+void JobSystem::setThreadCount(int numThreads)
+{
+    stop();
+    start(numThreads);
+}
+
+void JobSystem::start(int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = (int)std::thread::hardware_concurrency();
+    if (numThreads <= 0)
+        numThreads = 1;
+
+    for (int i = 0; i < numThreads; i++)
+        queues.push_back(std::make_unique<WorkQueue>());
+
+    running = true;
+    for (int i = 1; i < numThreads; i++)
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+void JobSystem::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    wake.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+
+    workers.clear();
+    queues.clear();
+}
+
+void JobSystem::parallelFor(int count, int grain, const std::function<void(int, int)> &f)
+{
+    if (count <= 0)
+        return;
+    if (grain < 1)
+        grain = 1;
+
+    // Nothing to share, skip the queues entirely
+    if (queues.size() == 1 || count <= grain)
+    {
+        f(0, count);
+        return;
+    }
+
+    int numJobs = (count + grain - 1) / grain;
+    std::atomic<int> pending(numJobs);
+
+    // Deal the chunks out round-robin so every thread starts with local work
+    for (int j = 0; j < numJobs; j++)
+    {
+        WorkQueue &queue = *queues[j % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back({&f, j * grain, std::min(count, (j + 1) * grain), &pending});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued += numJobs;
+    }
+    wake.notify_all();
+
+    // Help out until every chunk, including stolen ones, is done
+    Job job;
+    while (pending.load(std::memory_order_acquire) > 0)
+    {
+        if (popLocal(0, job) || steal(0, job))
+            run(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::workerLoop(int index)
+{
+    Job job;
+    while (true)
+    {
+        if (popLocal(index, job) || steal(index, job))
+        {
+            run(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]
+                  { return !running || queued.load() > 0; });
+        if (!running)
+            return;
+    }
+}
+
+bool JobSystem::popLocal(int index, Job &job)
+{
+    WorkQueue &queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty())
+        return false;
+
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    queued--;
+    return true;
+}
+
+bool JobSystem::steal(int index, Job &job)
+{
+    int n = (int)queues.size();
+    for (int k = 1; k < n; k++)
+    {
+        WorkQueue &queue = *queues[(index + k) % n];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            continue;
+
+        job = queue.jobs.front();
+        queue.jobs.pop_front();
+        queued--;
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::run(Job &job)
+{
+    (*job.f)(job.begin, job.end);
+    job.pending->fetch_sub(1, std::memory_order_release);
+}
@@ -1,12 +1,14 @@
 #include "light.h"
 
+#include <cstdio>
+
 void Light::Draw(Shader &objectShader, Shader &lightShader, Camera &camera, bool onlySetShader)
 {
     if (!onlySetShader)
         Model::Draw(objectShader, camera); // Draw the model as usual
 
     lightShader.Activate();
-    glUniform1f(glGetUniformLocation(lightShader.ID, "pointLightCount"), pointLightCount);
+    glUniform1f(lightShader.uniform("pointLightCount"), pointLightCount);
 
     if (type == "Directional")
     {
@@ -61,31 +63,37 @@ void Light::UI()
 
 void Light::Directional(Shader &shader)
 {
-    glUniform3f(glGetUniformLocation(shader.ID, "dLight.color"), material.albedo.x, material.albedo.y, material.albedo.z);
-    glUniform3f(glGetUniformLocation(shader.ID, "dLight.direction"), direction.x, direction.y, direction.z);
+    glUniform3f(shader.uniform("dLight.color"), material.albedo.x, material.albedo.y, material.albedo.z);
+    glUniform3f(shader.uniform("dLight.direction"), direction.x, direction.y, direction.z);
 }
 
 void Light::Point(Shader &shader, int index)
 {
-    std::string baseName = "pLight[" + std::to_string(index) + "].";
+    // Member names built on the stack, looked up in the shader's location table
+    char name[64];
+    auto member = [&](const char *field)
+    {
+        std::snprintf(name, sizeof(name), "pLight[%d].%s", index, field);
+        return shader.uniform(name);
+    };
 
-    glUniform3f(glGetUniformLocation(shader.ID, (baseName + "color").c_str()), material.albedo.x, material.albedo.y, material.albedo.z);
+    glUniform3f(member("color"), material.albedo.x, material.albedo.y, material.albedo.z);
 
-    glUniform3f(glGetUniformLocation(shader.ID, (baseName + "position").c_str()), translation.x, translation.y, translation.z);
-    glUniform1f(glGetUniformLocation(shader.ID, (baseName + "constant").c_str()), constant);
-    glUniform1f(glGetUniformLocation(shader.ID, (baseName + "linear").c_str()), linear);
-    glUniform1f(glGetUniformLocation(shader.ID, (baseName + "quadratic").c_str()), quadratic);
+    glUniform3f(member("position"), translation.x, translation.y, translation.z);
+    glUniform1f(member("constant"), constant);
+    glUniform1f(member("linear"), linear);
+    glUniform1f(member("quadratic"), quadratic);
 }
 
 void Light::Spot(Shader &shader)
 {
-    glUniform3f(glGetUniformLocation(shader.ID, "sLight.ambient"), material.albedo.x, material.albedo.y, material.albedo.z);
+    glUniform3f(shader.uniform("sLight.ambient"), material.albedo.x, material.albedo.y, material.albedo.z);
 
-    glUniform3f(glGetUniformLocation(shader.ID, "sLight.position"), translation.x, translation.y, translation.z);
-    glUniform3f(glGetUniformLocation(shader.ID, "sLight.direction"), direction.x, direction.y, direction.z);
-    glUniform1f(glGetUniformLocation(shader.ID, "sLight.constant"), constant);
-    glUniform1f(glGetUniformLocation(shader.ID, "sLight.linear"), linear);
-    glUniform1f(glGetUniformLocation(shader.ID, "sLight.quadratic"), quadratic);
-    glUniform1f(glGetUniformLocation(shader.ID, "sLight.cutOff"), glm::cos(glm::radians(cutoff)));
-    glUniform1f(glGetUniformLocation(shader.ID, "sLight.outerCutOff"), glm::cos(glm::radians(outerCutoff)));
+    glUniform3f(shader.uniform("sLight.position"), translation.x, translation.y, translation.z);
+    glUniform3f(shader.uniform("sLight.direction"), direction.x, direction.y, direction.z);
+    glUniform1f(shader.uniform("sLight.constant"), constant);
+    glUniform1f(shader.uniform("sLight.linear"), linear);
+    glUniform1f(shader.uniform("sLight.quadratic"), quadratic);
+    glUniform1f(shader.uniform("sLight.cutOff"), glm::cos(glm::radians(cutoff)));
+    glUniform1f(shader.uniform("sLight.outerCutOff"), glm::cos(glm::radians(outerCutoff)));
 }
@@ -1,5 +1,8 @@
 #include "Mesh.h"
 
+#include <cstdio>
+#include <cstring>
+
 Mesh::Mesh(std::vector<Vertex> &vertices, std::vector<GLuint> &indices, std::vector<Texture> &textures)
 {
     Mesh::vertices = vertices;
@@ -13,6 +16,8 @@ Mesh::Mesh(std::vector<Vertex> &vertices, std::vector<GLuint> &indices, std::vec
     VAO.LinkAttrib(VBO, 1, 3, GL_FLOAT, sizeof(Vertex), (void *)(3 * sizeof(float)));
     VAO.LinkAttrib(VBO, 2, 2, GL_FLOAT, sizeof(Vertex), (void *)(6 * sizeof(float)));
     VAO.Unbind();
+    vertexBuffer = VBO.ID;
+    indexBuffer = EBO.ID;
     VBO.Unbind();
     EBO.Unbind();
 }
@@ -29,34 +34,34 @@ void Mesh::Draw(
 {
     shader.Activate();
     VAO.Bind();
-    glUniform1i(glGetUniformLocation(shader.ID, "textured"), textured);
+    glUniform1i(shader.uniform("textured"), textured);
 
     unsigned int numDiffuse = 0;
     unsigned int numSpecular = 0;
 
-    // Bind textures
+    // Bind textures, the sampler name built on the stack rather than in a string per texture per draw
+    char name[64];
     for (unsigned int i = 0; i < textures.size(); i++)
     {
-        std::string num;
-        std::string type = textures[i].type;
-        if (type == "diffuse")
+        const char *type = textures[i].type;
+        if (std::strcmp(type, "diffuse") == 0)
         {
-            num = std::to_string(numDiffuse++);
+            std::snprintf(name, sizeof(name), "%s%u", type, numDiffuse++);
         }
-        else if (type == "specular")
+        else if (std::strcmp(type, "specular") == 0)
         {
-            num = std::to_string(numSpecular++);
+            std::snprintf(name, sizeof(name), "%s%u", type, numSpecular++);
         }
         else
         {
-            num = "Map";
+            std::snprintf(name, sizeof(name), "%sMap", type);
         }
-        textures[i].texUnit(shader, (type + num).c_str(), i + 3);
+        textures[i].texUnit(shader, name, i + 3);
         textures[i].Bind();
     }
 
     // Set camera position and view matrix
-    glUniform3f(glGetUniformLocation(shader.ID, "camPos"), camera.Position.x, camera.Position.y, camera.Position.z);
+    glUniform3f(shader.uniform("camPos"), camera.Position.x, camera.Position.y, camera.Position.z);
     camera.Matrix(shader, "camMatrix");
 
     // Create transformation matrices
@@ -64,11 +69,11 @@ void Mesh::Draw(
     matrix *= glm::mat4_cast(rotation);
     matrix = glm::scale(matrix, scale);
 
-    glUniformMatrix4fv(glGetUniformLocation(shader.ID, "model"), 1, GL_FALSE, glm::value_ptr(matrix));
-    glUniform3f(glGetUniformLocation(shader.ID, "material.albedo"), material.albedo.x, material.albedo.y, material.albedo.z);
-    glUniform1f(glGetUniformLocation(shader.ID, "material.metallic"), material.metallic);
-    glUniform1f(glGetUniformLocation(shader.ID, "material.roughness"), material.roughness);
-    glUniform1f(glGetUniformLocation(shader.ID, "material.ao"), material.ao);
+    glUniformMatrix4fv(shader.uniform("model"), 1, GL_FALSE, glm::value_ptr(matrix));
+    glUniform3f(shader.uniform("material.albedo"), material.albedo.x, material.albedo.y, material.albedo.z);
+    glUniform1f(shader.uniform("material.metallic"), material.metallic);
+    glUniform1f(shader.uniform("material.roughness"), material.roughness);
+    glUniform1f(shader.uniform("material.ao"), material.ao);
 
     // Draw the mesh
     glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
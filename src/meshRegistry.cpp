@@ -0,0 +1,32 @@
+#include "meshRegistry.h"
+
+Model &MeshRegistry::Get(const std::string &file)
+{
+    auto it = models.find(file);
+    if (it == models.end())
+    {
+        // The key outlives the Model, which keeps a pointer to the file name
+        it = models.emplace(file, nullptr).first;
+        it->second = std::make_unique<Model>(it->first.c_str(), file, false);
+    }
+    return *it->second;
+}
+
+Mesh &MeshRegistry::GetMesh(const std::string &file, unsigned int index)
+{
+    return Get(file).meshes[index];
+}
+
+void MeshRegistry::Clear()
+{
+    for (auto &entry : models)
+    {
+        for (Mesh &mesh : entry.second->meshes)
+        {
+            mesh.VAO.Delete();
+            glDeleteBuffers(1, &mesh.vertexBuffer);
+            glDeleteBuffers(1, &mesh.indexBuffer);
+        }
+    }
+    models.clear();
+}
@@ -0,0 +1,127 @@
+#include "particleRenderer.h"
+
+ParticleRenderer::ParticleRenderer(Mesh &mesh)
+{
+    indexCount = (GLsizei)mesh.indices.size();
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &instanceVBO);
+    glGenBuffers(1, &colorVBO);
+
+    glBindVertexArray(VAO);
+
+    // Reuse the mesh's buffers, only the instance streams belong to the renderer
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+    glEnableVertexAttribArray(0);
+
+    // Normal attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+
+    // Colour stream, only enabled while colours are given
+    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
+    glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+    glVertexAttribDivisor(colorLocation, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ParticleRenderer::reserve(size_t count)
+{
+    if (count <= capacity)
+        return;
+
+    capacity = capacity == 0 ? 1024 : capacity;
+    while (capacity < count)
+        capacity *= 2;
+
+    // Layout is [x...][y...][z...][radius...][px...][py...][pz...], one block of capacity floats each
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, numStreams * capacity * sizeof(float), nullptr, GL_STREAM_DRAW);
+
+    for (GLuint a = 0; a < numStreams; a++)
+    {
+        glVertexAttribPointer(3 + a, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *)(a * capacity * sizeof(float)));
+        glEnableVertexAttribArray(3 + a);
+        glVertexAttribDivisor(3 + a, 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void ParticleRenderer::upload(ParticleSystem &ps, const std::vector<glm::vec3> *colors)
+{
+    size_t count = ps.size();
+    reserve(count);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    const std::vector<float> *arrays[numStreams] = {&ps.x, &ps.y, &ps.z, &ps.radius, &ps.px, &ps.py, &ps.pz};
+    for (size_t a = 0; a < numStreams; a++)
+        glBufferSubData(GL_ARRAY_BUFFER, a * capacity * sizeof(float), count * sizeof(float), arrays[a]->data());
+
+    bool colorStream = colors != nullptr && colors->size() >= count;
+    if (colorStream)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
+        if (colorCapacity < capacity)
+        {
+            colorCapacity = capacity;
+            glBufferData(GL_ARRAY_BUFFER, colorCapacity * sizeof(glm::vec3), nullptr, GL_STREAM_DRAW);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::vec3), colors->data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(VAO);
+    if (colorStream)
+        glEnableVertexAttribArray(colorLocation);
+    else
+        glDisableVertexAttribArray(colorLocation);
+    glBindVertexArray(0);
+}
+
+void ParticleRenderer::Draw(ParticleSystem &ps, Shader &shader, const std::vector<glm::vec3> *colors)
+{
+    size_t count = ps.size();
+    if (count == 0)
+        return;
+
+    upload(ps, colors);
+
+    shader.Activate();
+
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, (GLsizei)count);
+    glBindVertexArray(0);
+}
+
+void ParticleRenderer::DrawImpostors(ParticleSystem &ps, Shader &shader)
+{
+    size_t count = ps.size();
+    if (count == 0)
+        return;
+
+    upload(ps, nullptr);
+
+    shader.Activate();
+
+    // The quad comes from gl_VertexID, the mesh attributes are bound but unused
+    glBindVertexArray(VAO);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+    glBindVertexArray(0);
+}
+
+void ParticleRenderer::Delete()
+{
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &instanceVBO);
+    glDeleteBuffers(1, &colorVBO);
+}
@@ -0,0 +1,100 @@
+#include "particleSystem.h"
+#include "simdKernels.h"
+
+ParticleHandle ParticleSystem::spawn(glm::vec3 pos, glm::vec3 vel, float r)
+{
+    uint32_t slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        slot = (uint32_t)slotToIndex.size();
+        slotToIndex.push_back(0);
+        slotGeneration.push_back(0);
+    }
+
+    slotToIndex[slot] = (uint32_t)size();
+    indexToSlot.push_back(slot);
+
+    x.push_back(pos.x);
+    y.push_back(pos.y);
+    z.push_back(pos.z);
+    vx.push_back(vel.x);
+    vy.push_back(vel.y);
+    vz.push_back(vel.z);
+    ax.push_back(0.0f);
+    ay.push_back(0.0f);
+    az.push_back(0.0f);
+    radius.push_back(r);
+    px.push_back(pos.x);
+    py.push_back(pos.y);
+    pz.push_back(pos.z);
+    sleepTimer.push_back(0.0f);
+
+    return {slot, slotGeneration[slot]};
+}
+
+void ParticleSystem::remove(ParticleHandle handle)
+{
+    if (!alive(handle))
+        return;
+
+    uint32_t i = slotToIndex[handle.slot];
+    uint32_t last = (uint32_t)size() - 1;
+
+    forEachArray([&](std::vector<float> &a)
+                 {
+                     a[i] = a[last];
+                     a.pop_back(); });
+
+    indexToSlot[i] = indexToSlot[last];
+    slotToIndex[indexToSlot[i]] = i;
+    indexToSlot.pop_back();
+
+    // Bumping the generation invalidates every handle still pointing at this slot
+    slotGeneration[handle.slot]++;
+    freeSlots.push_back(handle.slot);
+}
+
+void ParticleSystem::clear()
+{
+    forEachArray([](std::vector<float> &a)
+                 { a.clear(); });
+
+    for (uint32_t slot : indexToSlot)
+    {
+        slotGeneration[slot]++;
+        freeSlots.push_back(slot);
+    }
+    indexToSlot.clear();
+}
+
+void ParticleSystem::reserve(size_t count)
+{
+    forEachArray([count](std::vector<float> &a)
+                 { a.reserve(count); });
+    indexToSlot.reserve(count);
+}
+
+bool ParticleSystem::alive(ParticleHandle handle) const
+{
+    return handle.slot < slotGeneration.size() && slotGeneration[handle.slot] == handle.generation;
+}
+
+int ParticleSystem::indexOf(ParticleHandle handle) const
+{
+    return alive(handle) ? (int)slotToIndex[handle.slot] : -1;
+}
+
+void ParticleSystem::integrate(float dt, float g, int begin, int end)
+{
+    simdKernels().integrate(*this, dt, g, begin, end);
+}
+
+void ParticleSystem::constraint(float r, int begin, int end)
+{
+    simdKernels().constraint(*this, r, begin, end);
+}
@@ -1,36 +1,326 @@
 #include "physx.h"
+#include "profiler.h"
+#include "simdKernels.h"
 
-void Physx::update(float pr, float dt, float g, float r)
+#include <algorithm>
+#include <cmath>
+
+void Physx::update(ParticleSystem &ps, float pr, float dt, float g, float r, int subSteps)
 {
-    for (Particle *p1 : Particle::particles)
+    PROFILE_ZONE("Physx::update");
+    subSteps = std::max(subSteps, 1);
+
+    std::fill(ps.radius.begin(), ps.radius.end(), pr);
+
+    for (int s = 0; s < subSteps; s++)
+    {
+        PROFILE_ZONE("Substep");
+        subStep(ps, pr, dt / subSteps, g, r, s == 0);
+    }
+
+    if (sleeping)
     {
-        p1->radius = pr;
-        p1->model.scale = glm::vec3(pr, pr, pr);
-        p1->update(dt, g);
-        p1->constraint(r);
+        PROFILE_ZONE("Sleep");
+        updateSleep(ps, dt);
+    }
+}
+
+void Physx::subStep(ParticleSystem &ps, float pr, float dt, float g, float r, bool first)
+{
+    int n = (int)ps.size();
+
+    bool xpbd = contactModel == ContactModel::Xpbd;
+
+    active.clear();
+    awake.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        awake[i] = !asleep(ps, i);
+        if (awake[i])
+            active.push_back(i);
+    }
+
+    // A pile that is fully asleep costs nothing
+    if (active.empty())
+        return;
+
+    hash.spacing = pr * 2;
+    cellX.resize(n);
+    cellY.resize(n);
+    cellZ.resize(n);
+    if (xpbd)
+    {
+        startX.resize(n);
+        startY.resize(n);
+        startZ.resize(n);
+    }
+
+    Profiler &profiler = Profiler::Get();
+    int zone = profiler.beginZone("Integrate");
+    forActiveRuns([&](int begin, int end)
+                  {
+                      // Interpolation runs from where the whole step started
+                      if (first)
+                      {
+                          std::copy(ps.x.begin() + begin, ps.x.begin() + end, ps.px.begin() + begin);
+                          std::copy(ps.y.begin() + begin, ps.y.begin() + end, ps.py.begin() + begin);
+                          std::copy(ps.z.begin() + begin, ps.z.begin() + end, ps.pz.begin() + begin);
+                      }
 
-        for (Particle *p2 : Particle::particles)
+                      // Xpbd derives velocities from how far particles moved in the substep
+                      if (xpbd)
+                      {
+                          std::copy(ps.x.begin() + begin, ps.x.begin() + end, startX.begin() + begin);
+                          std::copy(ps.y.begin() + begin, ps.y.begin() + end, startY.begin() + begin);
+                          std::copy(ps.z.begin() + begin, ps.z.begin() + end, startZ.begin() + begin);
+                      }
+
+                      ps.integrate(dt, g, begin, end);
+                      ps.constraint(r, begin, end); });
+    profiler.endZone(zone);
+
+    // Sleeping particles keep their cells, but removes may have moved them to another index
+    zone = profiler.beginZone("Broadphase");
+    jobs.parallelFor(n, 4096, [&](int begin, int end)
+                     {
+                         for (int i = begin; i < end; i++)
+                         {
+                             cellX[i] = hash.intCoord(ps.x[i]);
+                             cellY[i] = hash.intCoord(ps.y[i]);
+                             cellZ[i] = hash.intCoord(ps.z[i]);
+                         } });
+
+    // Broadphase: bucket particles into cells one diameter wide
+    hash.create(n, ps.x.data(), ps.y.data(), ps.z.data());
+
+    // Cells get one of 27 colours from their coordinates mod 3. A particle only
+    // touches particles in the 3x3x3 block around its cell, and two cells of the
+    // same colour are at least 3 apart, so resolving every cell of one colour at
+    // once never writes a particle from two threads. Contacts are resolved from
+    // the awake side, so buckets without an awake particle are left out.
+    for (std::vector<int> &buckets : colourBuckets)
+        buckets.clear();
+
+    for (int h = 0; h < hash.tableSize; h++)
+    {
+        unsigned int seen = 0;
+        for (int k = hash.cellStart[h]; k < hash.cellStart[h + 1]; k++)
+        {
+            int i = hash.particleMap[k];
+            if (awake[i])
+                seen |= 1u << colourOf(i);
+        }
+
+        for (int c = 0; c < 27; c++)
         {
-            if (p2 == p1)
+            if (seen & (1u << c))
+                colourBuckets[c].push_back(h);
+        }
+    }
+
+    profiler.endZone(zone);
+
+    zone = profiler.beginZone("Contacts");
+    for (int c = 0; c < 27; c++)
+    {
+        std::vector<int> &buckets = colourBuckets[c];
+        jobs.parallelFor((int)buckets.size(), 64, [&](int begin, int end)
+                         {
+                             thread_local ContactScratch scratch;
+                             for (int b = begin; b < end; b++)
+                                 resolveBucket(ps, buckets[b], c, pr, dt, scratch); });
+    }
+    profiler.endZone(zone);
+
+    if (xpbd)
+    {
+        PROFILE_ZONE("Velocities");
+        forActiveRuns([&](int begin, int end)
+                      {
+                          for (int i = begin; i < end; i++)
+                          {
+                              ps.vx[i] = (ps.x[i] - startX[i]) / dt;
+                              ps.vy[i] = (ps.y[i] - startY[i]) / dt;
+                              ps.vz[i] = (ps.z[i] - startZ[i]) / dt;
+                          }
+
+                          // Contacts may have pushed particles back out of the container
+                          ps.constraint(r, begin, end); });
+    }
+}
+
+void Physx::updateSleep(ParticleSystem &ps, float dt)
+{
+    jobs.parallelFor((int)ps.size(), 4096, [&](int begin, int end)
+                     {
+                         for (int i = begin; i < end; i++)
+                         {
+                             if (asleep(ps, i))
+                                 continue;
+
+                             // Speed over the whole step rather than the last substep's velocity, which
+                             // contacts that can't all be satisfied keep shaking even in a settled pile
+                             float dx = ps.x[i] - ps.px[i];
+                             float dy = ps.y[i] - ps.py[i];
+                             float dz = ps.z[i] - ps.pz[i];
+                             float moved2 = dx * dx + dy * dy + dz * dz;
+                             ps.sleepTimer[i] = moved2 < sleepSpeed * sleepSpeed * dt * dt ? ps.sleepTimer[i] + dt : 0.0f;
+
+                             // Falls asleep where it is, and is drawn there
+                             if (asleep(ps, i))
+                             {
+                                 ps.vx[i] = ps.vy[i] = ps.vz[i] = 0.0f;
+                                 ps.px[i] = ps.x[i];
+                                 ps.py[i] = ps.y[i];
+                                 ps.pz[i] = ps.z[i];
+                             }
+                         } });
+}
+
+void Physx::forActiveRuns(const std::function<void(int, int)> &f)
+{
+    jobs.parallelFor((int)active.size(), 1024, [&](int begin, int end)
+                     {
+                         int k = begin;
+                         while (k < end)
+                         {
+                             int first = active[k++];
+                             int last = first;
+                             while (k < end && active[k] == last + 1)
+                             {
+                                 last++;
+                                 k++;
+                             }
+                             f(first, last + 1);
+                         } });
+}
+
+int Physx::colourOf(int i) const
+{
+    int cx = (cellX[i] % 3 + 3) % 3;
+    int cy = (cellY[i] % 3 + 3) % 3;
+    int cz = (cellZ[i] % 3 + 3) % 3;
+    return (cx * 3 + cy) * 3 + cz;
+}
+
+void Physx::resolveBucket(ParticleSystem &ps, int bucket, int colour, float pr, float dt, ContactScratch &scratch)
+{
+    const SimdKernels &kernels = simdKernels();
+
+    float *x = ps.x.data();
+    float *y = ps.y.data();
+    float *z = ps.z.data();
+    float *vx = ps.vx.data();
+    float *vy = ps.vy.data();
+    float *vz = ps.vz.data();
+
+    for (int k = hash.cellStart[bucket]; k < hash.cellStart[bucket + 1]; k++)
+    {
+        int i = hash.particleMap[k];
+
+        // Buckets can mix cells of different colours, and sleeping particles are left to their awake neighbours
+        if (!awake[i] || colourOf(i) != colour)
+            continue;
+
+        hash.queryCells(cellX[i] - 1, cellY[i] - 1, cellZ[i] - 1, cellX[i] + 1, cellY[i] + 1, cellZ[i] + 1, scratch.queryIds);
+
+        // Every pair is resolved once, and hash collisions from far away cells are ignored
+        scratch.candidates.clear();
+        for (int j : scratch.queryIds)
+        {
+            if ((j > i || !awake[j]) && std::abs(cellX[j] - cellX[i]) <= 1 && std::abs(cellY[j] - cellY[i]) <= 1 && std::abs(cellZ[j] - cellZ[i]) <= 1)
+                scratch.candidates.push_back(j);
+        }
+
+        // Vectorized distance test first, the few overlapping pairs are resolved one by one
+        scratch.hits.resize(scratch.candidates.size());
+        int numHits = kernels.findContacts(ps, i, scratch.candidates.data(), (int)scratch.candidates.size(), pr * 2, scratch.hits.data());
+
+        for (int h = 0; h < numHits; h++)
+        {
+            int j = scratch.hits[h];
+
+            // Earlier pairs may have moved particle i, so measure again
+            float dx = x[j] - x[i];
+            float dy = y[j] - y[i];
+            float dz = z[j] - z[i];
+            float dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+            if (dist >= pr * 2)
                 continue;
 
-            float dist = glm::distance(p1->pos, p2->pos);
-            if (dist < pr * 2)
+            // A hard enough contact wakes a sleeping particle, anything softer treats it as
+            // static. Only a particle that moved last step counts, the velocity of one at
+            // rest is mostly contact noise.
+            float rvx = vx[i] - vx[j];
+            float rvy = vy[i] - vy[j];
+            float rvz = vz[i] - vz[j];
+            bool moving = ps.sleepTimer[i] == 0.0f || ps.sleepTimer[j] == 0.0f;
+            if (sleeping && moving && 0.5f * (rvx * rvx + rvy * rvy + rvz * rvz) > wakeEnergy)
+            {
+                if (asleep(ps, j) && contactModel == ContactModel::Xpbd)
+                {
+                    startX[j] = x[j];
+                    startY[j] = y[j];
+                    startZ[j] = z[j];
+                }
+                ps.sleepTimer[i] = 0.0f;
+                ps.sleepTimer[j] = 0.0f;
+            }
+            float wj = asleep(ps, j) ? 0.0f : 1.0f; // Inverse mass
+
+            if (contactModel == ContactModel::Xpbd)
+            {
+                float nx = dx / dist;
+                float ny = dy / dist;
+                float nz = dz / dist;
+
+                // One XPBD iteration per substep, so the multiplier starts from zero.
+                // alphaTilde softens the contact, gamma damps how fast it closed
+                // during the substep (Macklin et al. 2016, eq. 26)
+                float alphaTilde = compliance / (dt * dt);
+                float gamma = compliance * damping / dt;
+                float constraint = dist - pr * 2;
+                float closing = nx * ((x[j] - startX[j]) * wj - (x[i] - startX[i])) +
+                                ny * ((y[j] - startY[j]) * wj - (y[i] - startY[i])) +
+                                nz * ((z[j] - startZ[j]) * wj - (z[i] - startZ[i]));
+                float deltaLambda = (-constraint - gamma * closing) / ((1.0f + gamma) * (1.0f + wj) + alphaTilde);
+
+                x[i] -= nx * deltaLambda;
+                y[i] -= ny * deltaLambda;
+                z[i] -= nz * deltaLambda;
+                x[j] += nx * deltaLambda * wj;
+                y[j] += ny * deltaLambda * wj;
+                z[j] += nz * deltaLambda * wj;
+            }
+            else
             {
                 float overlap = pr * 2 - dist;
-                glm::vec3 collisionNormal = glm::normalize(p2->pos - p1->pos);
-                glm::vec3 correction = collisionNormal * (overlap / 2.0f);
-                p1->pos -= correction;
-                p2->pos += correction;
+                float nx = dx / dist;
+                float ny = dy / dist;
+                float nz = dz / dist;
+
+                // Split evenly, or all on i against a static particle
+                float share = 1.0f / (1.0f + wj);
+
+                float c = overlap * share;
+                x[i] -= nx * c;
+                y[i] -= ny * c;
+                z[i] -= nz * c;
+                x[j] += nx * c * wj;
+                y[j] += ny * c * wj;
+                z[j] += nz * c * wj;
 
-                glm::vec3 relativeVel = p1->vel - p2->vel;
-                float impulseMagnitude = glm::dot(relativeVel, collisionNormal);
+                float impulseMagnitude = rvx * nx + rvy * ny + rvz * nz;
 
                 float restitution = 0.8f;
-                glm::vec3 impulse = collisionNormal * impulseMagnitude * restitution;
+                float impulse = impulseMagnitude * restitution * share;
 
-                p1->vel -= impulse * 0.5f;
-                p2->vel += impulse * 0.5f;
+                vx[i] -= nx * impulse;
+                vy[i] -= ny * impulse;
+                vz[i] -= nz * impulse;
+                vx[j] += nx * impulse * wj;
+                vy[j] += ny * impulse * wj;
+                vz[j] += nz * impulse * wj;
             }
         }
     }
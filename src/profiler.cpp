@@ -0,0 +1,185 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "json.h"
+
+using json = nlohmann::json;
+
+Profiler::Profiler(int capacity)
+{
+    // One more slot than finished frames, for the frame being recorded
+    frames.resize(std::max(capacity, 1) + 1);
+    origin = std::chrono::steady_clock::now();
+}
+
+Profiler &Profiler::Get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+double Profiler::now() const
+{
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - origin;
+    return elapsed.count();
+}
+
+void Profiler::beginFrame()
+{
+    frameNumber++;
+    inFrame = recording;
+    if (!inFrame)
+        return;
+
+    ProfileFrame &f = frames[head];
+    f.frame = frameNumber;
+    f.startMs = now();
+    f.durationMs = 0.0;
+    f.zones.clear();
+    depth = 0;
+    owner = std::this_thread::get_id();
+}
+
+void Profiler::endFrame()
+{
+    if (!inFrame)
+        return;
+    inFrame = false;
+
+    ProfileFrame &f = frames[head];
+    f.durationMs = now() - f.startMs;
+
+    head = (head + 1) % (int)frames.size();
+    count = std::min(count + 1, (int)frames.size() - 1);
+}
+
+int Profiler::beginZone(const char *name)
+{
+    if (!inFrame || std::this_thread::get_id() != owner)
+        return -1;
+
+    ProfileFrame &f = frames[head];
+    f.zones.push_back({name, ProfileLane::Cpu, depth++, now() - f.startMs, 0.0});
+    return (int)f.zones.size() - 1;
+}
+
+void Profiler::endZone(int zone)
+{
+    // Zones still open when the frame ended are dropped with it
+    ProfileFrame &f = frames[head];
+    if (zone < 0 || !inFrame || zone >= (int)f.zones.size())
+        return;
+
+    depth--;
+    f.zones[zone].durationMs = now() - f.startMs - f.zones[zone].startMs;
+}
+
+void Profiler::addZone(long long frame, const ProfileZone &zone)
+{
+    if (!recording)
+        return;
+
+    ProfileFrame *f = find(frame);
+    if (f != nullptr)
+        f->zones.push_back(zone);
+}
+
+const ProfileFrame &Profiler::frame(int i) const
+{
+    int oldest = head - count + (int)frames.size();
+    return frames[(oldest + i) % (int)frames.size()];
+}
+
+ProfileFrame *Profiler::find(long long frame)
+{
+    for (ProfileFrame &f : frames)
+    {
+        if (f.frame == frame)
+            return &f;
+    }
+    return nullptr;
+}
+
+double Profiler::averageMs(const char *name, ProfileLane lane, int frames) const
+{
+    double total = 0.0;
+    int seen = 0;
+    for (int i = std::max(count - frames, 0); i < count; i++)
+    {
+        bool found = false;
+        for (const ProfileZone &zone : frame(i).zones)
+        {
+            if (zone.lane == lane && std::strcmp(zone.name, name) == 0)
+            {
+                total += zone.durationMs;
+                found = true;
+            }
+        }
+        // GPU zones arrive late, so frames that don't have it yet don't count
+        if (found)
+            seen++;
+    }
+    return seen > 0 ? total / seen : 0.0;
+}
+
+bool Profiler::writeCsv(const std::string &filename) const
+{
+    FILE *file = std::fopen(filename.c_str(), "w");
+    if (file == nullptr)
+    {
+        std::cout << "Unable to open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    std::fprintf(file, "frame,lane,name,depth,start_ms,duration_ms\n");
+    for (int i = 0; i < count; i++)
+    {
+        const ProfileFrame &f = frame(i);
+        std::fprintf(file, "%lld,frame,Frame,-1,%.6f,%.6f\n", f.frame, f.startMs, f.durationMs);
+        for (const ProfileZone &zone : f.zones)
+        {
+            std::fprintf(file, "%lld,%s,%s,%d,%.6f,%.6f\n", f.frame, zone.lane == ProfileLane::Cpu ? "cpu" : "gpu",
+                         zone.name, zone.depth, f.startMs + zone.startMs, zone.durationMs);
+        }
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+bool Profiler::writeChromeTrace(const std::string &filename) const
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+    {
+        std::cout << "Unable to open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    // Complete ("X") events in microseconds, CPU and GPU as two threads of one process
+    json events = json::array();
+    for (int i = 0; i < count; i++)
+    {
+        const ProfileFrame &f = frame(i);
+        events.push_back({{"name", "Frame"}, {"cat", "frame"}, {"ph", "X"}, {"pid", 0}, {"tid", 0}, {"ts", f.startMs * 1000.0}, {"dur", f.durationMs * 1000.0}, {"args", {{"frame", f.frame}}}});
+        for (const ProfileZone &zone : f.zones)
+        {
+            bool cpu = zone.lane == ProfileLane::Cpu;
+            events.push_back({{"name", zone.name}, {"cat", cpu ? "cpu" : "gpu"}, {"ph", "X"}, {"pid", 0}, {"tid", cpu ? 0 : 1}, {"ts", (f.startMs + zone.startMs) * 1000.0}, {"dur", zone.durationMs * 1000.0}});
+        }
+    }
+
+    events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 0}, {"tid", 0}, {"args", {{"name", "CPU"}}}});
+    events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 0}, {"tid", 1}, {"args", {{"name", "GPU"}}}});
+
+    json trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+    file << trace.dump();
+    return true;
+}
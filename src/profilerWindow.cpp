@@ -0,0 +1,139 @@
+#include "profilerWindow.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cstdio>
+
+// Stable colour per zone name, so a zone keeps its colour from frame to frame
+static ImU32 zoneColour(const char *name)
+{
+    unsigned int h = 2166136261u;
+    for (const char *c = name; *c != '\0'; c++)
+        h = (h ^ (unsigned char)*c) * 16777619u;
+    return IM_COL32(80 + h % 128, 80 + (h >> 8) % 128, 80 + (h >> 16) % 128, 255);
+}
+
+void ProfilerWindow::Draw(Profiler &profiler)
+{
+    ImGui::Begin("Profiler");
+
+    ImGui::Checkbox("Record", &profiler.recording);
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV"))
+        profiler.writeCsv("profile.csv");
+    ImGui::SameLine();
+    if (ImGui::Button("Export Chrome Trace"))
+        profiler.writeChromeTrace("profile.json");
+
+    int count = profiler.frameCount();
+    if (count == 0)
+    {
+        ImGui::Text("No frames recorded");
+        ImGui::End();
+        return;
+    }
+
+    // Find the frame to show, falling back to following if the pinned one left the ring
+    int shown = std::max(count - 1 - followLag, 0);
+    for (int i = 0; pinned >= 0 && i < count; i++)
+    {
+        if (profiler.frame(i).frame == pinned)
+            shown = i;
+    }
+    if (pinned >= 0 && profiler.frame(shown).frame != pinned)
+        pinned = -1;
+
+    ImDrawList *draw = ImGui::GetWindowDrawList();
+    float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+
+    // Frame time bars, scaled to the slowest frame in the ring
+    double slowest = 1.0;
+    for (int i = 0; i < count; i++)
+        slowest = std::max(slowest, profiler.frame(i).durationMs);
+
+    const float graphHeight = 60.0f;
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("frames", ImVec2(width, graphHeight));
+    bool graphHovered = ImGui::IsItemHovered();
+    bool graphClicked = ImGui::IsItemClicked();
+
+    float barWidth = width / count;
+    draw->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + graphHeight), IM_COL32(30, 30, 30, 255));
+    for (int i = 0; i < count; i++)
+    {
+        float h = (float)(profiler.frame(i).durationMs / slowest) * graphHeight;
+        float x = origin.x + i * barWidth;
+        ImU32 colour = i == shown ? IM_COL32(255, 200, 60, 255) : IM_COL32(90, 160, 220, 255);
+        draw->AddRectFilled(ImVec2(x, origin.y + graphHeight - h), ImVec2(x + std::max(barWidth - 1.0f, 1.0f), origin.y + graphHeight), colour);
+    }
+
+    if (graphHovered)
+    {
+        int i = std::clamp((int)((ImGui::GetIO().MousePos.x - origin.x) / barWidth), 0, count - 1);
+        const ProfileFrame &f = profiler.frame(i);
+        ImGui::SetTooltip("Frame %lld: %.3f ms", f.frame, f.durationMs);
+        if (graphClicked)
+            pinned = pinned == f.frame ? -1 : f.frame;
+    }
+
+    const ProfileFrame &frame = profiler.frame(shown);
+    ImGui::Text("Frame %lld: %.3f ms%s", frame.frame, frame.durationMs, pinned >= 0 ? " (pinned)" : "");
+
+    // Timeline: CPU rows by depth, then GPU rows by depth. The GPU runs behind
+    // the CPU, so the span covers whichever lane finishes last.
+    int cpuRows = 0;
+    int gpuRows = 0;
+    double span = frame.durationMs;
+    for (const ProfileZone &zone : frame.zones)
+    {
+        int &rows = zone.lane == ProfileLane::Cpu ? cpuRows : gpuRows;
+        rows = std::max(rows, zone.depth + 1);
+        span = std::max(span, zone.startMs + zone.durationMs);
+    }
+    span = std::max(span, 1e-3);
+
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    float timelineHeight = (cpuRows + gpuRows + (gpuRows > 0 ? 1 : 0)) * rowHeight + 1.0f;
+    origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("timeline", ImVec2(width, std::max(timelineHeight, rowHeight)));
+    bool timelineHovered = ImGui::IsItemHovered();
+    ImVec2 mouse = ImGui::GetIO().MousePos;
+
+    ImVec2 end(origin.x + width, origin.y + std::max(timelineHeight, rowHeight));
+    draw->AddRectFilled(origin, end, IM_COL32(30, 30, 30, 255));
+    draw->PushClipRect(origin, end, true);
+
+    // The frame's own extent, so GPU work past it reads as lag
+    float frameEnd = origin.x + (float)(frame.durationMs / span) * width;
+    draw->AddLine(ImVec2(frameEnd, origin.y), ImVec2(frameEnd, end.y), IM_COL32(255, 255, 255, 80));
+
+    if (gpuRows > 0)
+        draw->AddText(ImVec2(origin.x + 2.0f, origin.y + cpuRows * rowHeight + 2.0f), IM_COL32(200, 200, 200, 255), "GPU");
+
+    for (const ProfileZone &zone : frame.zones)
+    {
+        int row = zone.lane == ProfileLane::Cpu ? zone.depth : cpuRows + 1 + zone.depth;
+        float x0 = origin.x + (float)(zone.startMs / span) * width;
+        float x1 = std::max(origin.x + (float)((zone.startMs + zone.durationMs) / span) * width, x0 + 1.0f);
+        float y0 = origin.y + row * rowHeight;
+        float y1 = y0 + rowHeight - 1.0f;
+
+        draw->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), zoneColour(zone.name));
+
+        // Label only what fits
+        float textWidth = ImGui::CalcTextSize(zone.name).x;
+        if (x1 - x0 > textWidth + 4.0f)
+            draw->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), zone.name);
+
+        if (timelineHovered && mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1)
+        {
+            ImGui::SetTooltip("%s (%s): %.3f ms\nstarts at %.3f ms", zone.name, zone.lane == ProfileLane::Cpu ? "CPU" : "GPU",
+                              zone.durationMs, zone.startMs);
+        }
+    }
+
+    draw->PopClipRect();
+
+    ImGui::End();
+}
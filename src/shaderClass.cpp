@@ -17,12 +17,73 @@ std::string get_file_contents(const char *filename)
     throw(errno);
 }
 
+// Reads a shader file and pastes in the files it #includes, GLSL has no include of its own
+std::string get_shader_source(const char *filename)
+{
+    std::string path(filename);
+    std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+
+    std::stringstream in(get_file_contents(filename));
+    std::string source;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        size_t start = line.find_first_not_of(" \t");
+        // Only quoted includes are ours, <...> ones belong to the C++ half of shared headers
+        size_t open = line.find('"');
+        if (start != std::string::npos && line.compare(start, 8, "#include") == 0 && open != std::string::npos)
+        {
+            size_t close = line.find('"', open + 1);
+            source += get_shader_source((directory + line.substr(open + 1, close - open - 1)).c_str());
+        }
+        else
+        {
+            source += line + "\n";
+        }
+    }
+    return source;
+}
+
+void UniformTable::build(GLuint program)
+{
+    locations.clear();
+
+    GLint count = 0;
+    glGetProgramInterfaceiv(program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+
+    char name[256];
+    const GLenum properties[] = {GL_LOCATION, GL_ARRAY_SIZE};
+    for (GLint i = 0; i < count; i++)
+    {
+        GLint values[2];
+        glGetProgramResourceiv(program, GL_UNIFORM, i, 2, properties, 2, nullptr, values);
+        if (values[0] < 0)
+            continue; // In a uniform block
+
+        glGetProgramResourceName(program, GL_UNIFORM, i, sizeof(name), nullptr, name);
+        std::string uniformName(name);
+        locations[uniformName] = values[0];
+
+        // Arrays come as "name[0]", register the bare name and every element
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+        {
+            std::string base = uniformName.substr(0, uniformName.size() - 3);
+            locations[base] = values[0];
+            for (GLint element = 1; element < values[1]; element++)
+            {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                locations[elementName] = glGetUniformLocation(program, elementName.c_str());
+            }
+        }
+    }
+}
+
 // Constructor that build the Shader Program from 2 different shaders
 Shader::Shader(const char *vertexFile, const char *fragmentFile)
 {
     // Read vertexFile and fragmentFile and store the strings
-    std::string vertexCode = get_file_contents(vertexFile);
-    std::string fragmentCode = get_file_contents(fragmentFile);
+    std::string vertexCode = get_shader_source(vertexFile);
+    std::string fragmentCode = get_shader_source(fragmentFile);
 
     // Convert the shader source strings into character arrays
     const char *vertexSource = vertexCode.c_str();
@@ -55,6 +116,7 @@ Shader::Shader(const char *vertexFile, const char *fragmentFile)
     glLinkProgram(ID);
     // Checks if Shaders linked succesfully
     compileErrors(ID, "PROGRAM");
+    uniforms.build(ID);
 
     // Delete the now useless Vertex and Fragment Shader objects
     glDeleteShader(vertexShader);
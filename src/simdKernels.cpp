@@ -0,0 +1,382 @@
+#include "simdKernels.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define PHYSX_SIMD_X86
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define PHYSX_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// ------------------------------------------------------------------------
+// Scalar
+// ------------------------------------------------------------------------
+
+static void integrateScalar(ParticleSystem &ps, float dt, float g, int begin, int end)
+{
+    float *x = ps.x.data(), *y = ps.y.data(), *z = ps.z.data();
+    float *vx = ps.vx.data(), *vy = ps.vy.data(), *vz = ps.vz.data();
+    float *ax = ps.ax.data(), *ay = ps.ay.data(), *az = ps.az.data();
+
+    for (int i = begin; i < end; i++)
+    {
+        float newAx = 0.0f;
+        float newAy = -g;
+        float newAz = 0.0f;
+
+        // Friction opposing the current velocity
+        float speed = std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+        if (speed > 0.001f)
+        {
+            float inv = 1.0f / speed;
+            newAx += -(vx[i] * inv) * 0.2f * speed;
+            newAy += -(vy[i] * inv) * 0.2f * speed;
+            newAz += -(vz[i] * inv) * 0.2f * speed;
+        }
+
+        float h = dt * dt * 0.5f;
+        x[i] += vx[i] * dt + ax[i] * h;
+        y[i] += vy[i] * dt + ay[i] * h;
+        z[i] += vz[i] * dt + az[i] * h;
+
+        float newVx = vx[i] + (ax[i] + newAx) * (dt * 0.5f);
+        float newVy = vy[i] + (ay[i] + newAy) * (dt * 0.5f);
+        float newVz = vz[i] + (az[i] + newAz) * (dt * 0.5f);
+
+        bool resting = std::sqrt(newVx * newVx + newVy * newVy + newVz * newVz) < 0.001f;
+        vx[i] = resting ? 0.0f : newVx;
+        vy[i] = resting ? 0.0f : newVy;
+        vz[i] = resting ? 0.0f : newVz;
+
+        ax[i] = newAx;
+        ay[i] = newAy;
+        az[i] = newAz;
+    }
+}
+
+static void constraintScalar(ParticleSystem &ps, float r, int begin, int end)
+{
+    float *x = ps.x.data(), *y = ps.y.data(), *z = ps.z.data();
+    float *vx = ps.vx.data(), *vy = ps.vy.data(), *vz = ps.vz.data();
+
+    for (int i = begin; i < end; i++)
+    {
+        float distance = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+
+        if (distance > r)
+        {
+            float nx = x[i] / distance;
+            float ny = y[i] / distance;
+            float nz = z[i] / distance;
+
+            x[i] = nx * r;
+            y[i] = ny * r;
+            z[i] = nz * r;
+
+            float vn = vx[i] * nx + vy[i] * ny + vz[i] * nz;
+            vx[i] -= vn * nx;
+            vy[i] -= vn * ny;
+            vz[i] -= vn * nz;
+        }
+    }
+}
+
+static int findContactsScalar(const ParticleSystem &ps, int i, const int *ids, int count, float minDist, int *hits)
+{
+    const float *x = ps.x.data(), *y = ps.y.data(), *z = ps.z.data();
+    int numHits = 0;
+
+    for (int k = 0; k < count; k++)
+    {
+        int j = ids[k];
+        float dx = x[j] - x[i];
+        float dy = y[j] - y[i];
+        float dz = z[j] - z[i];
+        if (std::sqrt(dx * dx + dy * dy + dz * dz) < minDist)
+            hits[numHits++] = j;
+    }
+    return numHits;
+}
+
+static const SimdKernels scalarKernels = {SimdLevel::Scalar, "scalar", integrateScalar, constraintScalar, findContactsScalar};
+
+// ------------------------------------------------------------------------
+// Wide kernels, written once against a small set of wrappers per ISA
+// ------------------------------------------------------------------------
+
+#if defined(PHYSX_SIMD_X86)
+
+#if defined(__GNUC__)
+#define PHYSX_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PHYSX_TARGET(isa)
+#endif
+
+// SSE, 4 lanes
+struct SSE
+{
+    typedef __m128 V;
+    static const int width = 4;
+    PHYSX_TARGET("sse2") static V load(const float *p) { return _mm_loadu_ps(p); }
+    PHYSX_TARGET("sse2") static void store(float *p, V v) { _mm_storeu_ps(p, v); }
+    PHYSX_TARGET("sse2") static V set(float f) { return _mm_set1_ps(f); }
+    PHYSX_TARGET("sse2") static V add(V a, V b) { return _mm_add_ps(a, b); }
+    PHYSX_TARGET("sse2") static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    PHYSX_TARGET("sse2") static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    PHYSX_TARGET("sse2") static V div(V a, V b) { return _mm_div_ps(a, b); }
+    PHYSX_TARGET("sse2") static V sqrt(V a) { return _mm_sqrt_ps(a); }
+    PHYSX_TARGET("sse2") static V neg(V a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    PHYSX_TARGET("sse2") static V gt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+    PHYSX_TARGET("sse2") static V lt(V a, V b) { return _mm_cmplt_ps(a, b); }
+    PHYSX_TARGET("sse2") static V andMask(V m, V a) { return _mm_and_ps(m, a); }
+    PHYSX_TARGET("sse2") static V andNotMask(V m, V a) { return _mm_andnot_ps(m, a); }
+    PHYSX_TARGET("sse2") static V select(V m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    PHYSX_TARGET("sse2") static int bits(V m) { return _mm_movemask_ps(m); }
+    PHYSX_TARGET("sse2") static V gather(const float *base, const int *ids)
+    {
+        return _mm_setr_ps(base[ids[0]], base[ids[1]], base[ids[2]], base[ids[3]]);
+    }
+};
+#define PHYSX_SSE_TARGET PHYSX_TARGET("sse2")
+
+// AVX2, 8 lanes. FMA is left out on purpose so results match the scalar path.
+struct AVX2
+{
+    typedef __m256 V;
+    static const int width = 8;
+    PHYSX_TARGET("avx2") static V load(const float *p) { return _mm256_loadu_ps(p); }
+    PHYSX_TARGET("avx2") static void store(float *p, V v) { _mm256_storeu_ps(p, v); }
+    PHYSX_TARGET("avx2") static V set(float f) { return _mm256_set1_ps(f); }
+    PHYSX_TARGET("avx2") static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    PHYSX_TARGET("avx2") static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    PHYSX_TARGET("avx2") static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    PHYSX_TARGET("avx2") static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    PHYSX_TARGET("avx2") static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+    PHYSX_TARGET("avx2") static V neg(V a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    PHYSX_TARGET("avx2") static V gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    PHYSX_TARGET("avx2") static V lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    PHYSX_TARGET("avx2") static V andMask(V m, V a) { return _mm256_and_ps(m, a); }
+    PHYSX_TARGET("avx2") static V andNotMask(V m, V a) { return _mm256_andnot_ps(m, a); }
+    PHYSX_TARGET("avx2") static V select(V m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+    PHYSX_TARGET("avx2") static int bits(V m) { return _mm256_movemask_ps(m); }
+    PHYSX_TARGET("avx2") static V gather(const float *base, const int *ids)
+    {
+        return _mm256_i32gather_ps(base, _mm256_loadu_si256((const __m256i *)ids), 4);
+    }
+};
+#define PHYSX_AVX2_TARGET PHYSX_TARGET("avx2")
+
+#elif defined(PHYSX_SIMD_NEON)
+
+// NEON, 4 lanes
+struct NEON
+{
+    typedef float32x4_t V;
+    static const int width = 4;
+    static V load(const float *p) { return vld1q_f32(p); }
+    static void store(float *p, V v) { vst1q_f32(p, v); }
+    static V set(float f) { return vdupq_n_f32(f); }
+    static V add(V a, V b) { return vaddq_f32(a, b); }
+    static V sub(V a, V b) { return vsubq_f32(a, b); }
+    static V mul(V a, V b) { return vmulq_f32(a, b); }
+    static V div(V a, V b) { return vdivq_f32(a, b); }
+    static V sqrt(V a) { return vsqrtq_f32(a); }
+    static V neg(V a) { return vnegq_f32(a); }
+    static V gt(V a, V b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+    static V lt(V a, V b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+    static V andMask(V m, V a) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(m), vreinterpretq_u32_f32(a))); }
+    static V andNotMask(V m, V a) { return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(m))); }
+    static V select(V m, V a, V b) { return vbslq_f32(vreinterpretq_u32_f32(m), a, b); }
+    static int bits(V m)
+    {
+        uint32x4_t u = vshrq_n_u32(vreinterpretq_u32_f32(m), 31);
+        return (int)(vgetq_lane_u32(u, 0) | (vgetq_lane_u32(u, 1) << 1) | (vgetq_lane_u32(u, 2) << 2) | (vgetq_lane_u32(u, 3) << 3));
+    }
+    static V gather(const float *base, const int *ids)
+    {
+        float v[4] = {base[ids[0]], base[ids[1]], base[ids[2]], base[ids[3]]};
+        return vld1q_f32(v);
+    }
+};
+
+#endif
+
+#if defined(PHYSX_SIMD_X86) || defined(PHYSX_SIMD_NEON)
+
+// The attribute has to sit on every function using the wider registers, so the
+// kernels are stamped out per ISA by this macro instead of a plain template
+#define PHYSX_DEFINE_KERNELS(S, TARGET)                                                                          \
+    TARGET static void integrate##S(ParticleSystem &ps, float dt, float g, int begin, int end)                   \
+    {                                                                                                            \
+        float *x = ps.x.data(), *y = ps.y.data(), *z = ps.z.data();                                              \
+        float *vx = ps.vx.data(), *vy = ps.vy.data(), *vz = ps.vz.data();                                        \
+        float *ax = ps.ax.data(), *ay = ps.ay.data(), *az = ps.az.data();                                        \
+                                                                                                                 \
+        const S::V zero = S::set(0.0f), minSpeed = S::set(0.001f), friction = S::set(0.2f);                      \
+        const S::V gravity = S::set(-g), one = S::set(1.0f);                                                     \
+        const S::V vdt = S::set(dt), h = S::set(dt * dt * 0.5f), halfDt = S::set(dt * 0.5f);                     \
+                                                                                                                 \
+        int i = begin;                                                                                           \
+        for (; i + S::width <= end; i += S::width)                                                               \
+        {                                                                                                        \
+            S::V px = S::load(x + i), py = S::load(y + i), pz = S::load(z + i);                                  \
+            S::V ux = S::load(vx + i), uy = S::load(vy + i), uz = S::load(vz + i);                               \
+            S::V aX = S::load(ax + i), aY = S::load(ay + i), aZ = S::load(az + i);                               \
+                                                                                                                 \
+            S::V speed = S::sqrt(S::add(S::add(S::mul(ux, ux), S::mul(uy, uy)), S::mul(uz, uz)));                \
+            S::V moving = S::gt(speed, minSpeed);                                                                \
+            S::V inv = S::div(one, speed);                                                                       \
+            S::V fx = S::mul(S::mul(S::neg(S::mul(ux, inv)), friction), speed);                                  \
+            S::V fy = S::mul(S::mul(S::neg(S::mul(uy, inv)), friction), speed);                                  \
+            S::V fz = S::mul(S::mul(S::neg(S::mul(uz, inv)), friction), speed);                                  \
+            S::V nAx = S::select(moving, S::add(zero, fx), zero);                                                \
+            S::V nAy = S::select(moving, S::add(gravity, fy), gravity);                                          \
+            S::V nAz = S::select(moving, S::add(zero, fz), zero);                                                \
+                                                                                                                 \
+            S::store(x + i, S::add(px, S::add(S::mul(ux, vdt), S::mul(aX, h))));                                 \
+            S::store(y + i, S::add(py, S::add(S::mul(uy, vdt), S::mul(aY, h))));                                 \
+            S::store(z + i, S::add(pz, S::add(S::mul(uz, vdt), S::mul(aZ, h))));                                 \
+                                                                                                                 \
+            S::V nVx = S::add(ux, S::mul(S::add(aX, nAx), halfDt));                                              \
+            S::V nVy = S::add(uy, S::mul(S::add(aY, nAy), halfDt));                                              \
+            S::V nVz = S::add(uz, S::mul(S::add(aZ, nAz), halfDt));                                              \
+                                                                                                                 \
+            S::V resting = S::lt(S::sqrt(S::add(S::add(S::mul(nVx, nVx), S::mul(nVy, nVy)), S::mul(nVz, nVz))), \
+                                 minSpeed);                                                                      \
+            S::store(vx + i, S::andNotMask(resting, nVx));                                                       \
+            S::store(vy + i, S::andNotMask(resting, nVy));                                                       \
+            S::store(vz + i, S::andNotMask(resting, nVz));                                                       \
+                                                                                                                 \
+            S::store(ax + i, nAx);                                                                               \
+            S::store(ay + i, nAy);                                                                               \
+            S::store(az + i, nAz);                                                                               \
+        }                                                                                                        \
+        integrateScalar(ps, dt, g, i, end);                                                                      \
+    }                                                                                                            \
+                                                                                                                 \
+    TARGET static void constraint##S(ParticleSystem &ps, float r, int begin, int end)                            \
+    {                                                                                                            \
+        float *x = ps.x.data(), *y = ps.y.data(), *z = ps.z.data();                                              \
+        float *vx = ps.vx.data(), *vy = ps.vy.data(), *vz = ps.vz.data();                                        \
+        const S::V radius = S::set(r);                                                                           \
+                                                                                                                 \
+        int i = begin;                                                                                           \
+        for (; i + S::width <= end; i += S::width)                                                               \
+        {                                                                                                        \
+            S::V px = S::load(x + i), py = S::load(y + i), pz = S::load(z + i);                                  \
+            S::V distance = S::sqrt(S::add(S::add(S::mul(px, px), S::mul(py, py)), S::mul(pz, pz)));            \
+            S::V outside = S::gt(distance, radius);                                                              \
+            if (S::bits(outside) == 0)                                                                           \
+                continue;                                                                                        \
+                                                                                                                 \
+            S::V nx = S::div(px, distance), ny = S::div(py, distance), nz = S::div(pz, distance);                \
+            S::store(x + i, S::select(outside, S::mul(nx, radius), px));                                         \
+            S::store(y + i, S::select(outside, S::mul(ny, radius), py));                                         \
+            S::store(z + i, S::select(outside, S::mul(nz, radius), pz));                                         \
+                                                                                                                 \
+            S::V ux = S::load(vx + i), uy = S::load(vy + i), uz = S::load(vz + i);                               \
+            S::V vn = S::add(S::add(S::mul(ux, nx), S::mul(uy, ny)), S::mul(uz, nz));                            \
+            S::store(vx + i, S::select(outside, S::sub(ux, S::mul(vn, nx)), ux));                                \
+            S::store(vy + i, S::select(outside, S::sub(uy, S::mul(vn, ny)), uy));                                \
+            S::store(vz + i, S::select(outside, S::sub(uz, S::mul(vn, nz)), uz));                                \
+        }                                                                                                        \
+        constraintScalar(ps, r, i, end);                                                                         \
+    }                                                                                                            \
+                                                                                                                 \
+    TARGET static int findContacts##S(const ParticleSystem &ps, int i, const int *ids, int count, float minDist, \
+                                      int *hits)                                                                 \
+    {                                                                                                            \
+        const float *x = ps.x.data(), *y = ps.y.data(), *z = ps.z.data();                                        \
+        const S::V px = S::set(x[i]), py = S::set(y[i]), pz = S::set(z[i]), limit = S::set(minDist);             \
+                                                                                                                 \
+        int numHits = 0;                                                                                         \
+        int k = 0;                                                                                               \
+        for (; k + S::width <= count; k += S::width)                                                             \
+        {                                                                                                        \
+            S::V dx = S::sub(S::gather(x, ids + k), px);                                                         \
+            S::V dy = S::sub(S::gather(y, ids + k), py);                                                         \
+            S::V dz = S::sub(S::gather(z, ids + k), pz);                                                         \
+            int mask = S::bits(S::lt(S::sqrt(S::add(S::add(S::mul(dx, dx), S::mul(dy, dy)), S::mul(dz, dz))),    \
+                                     limit));                                                                    \
+            for (int lane = 0; mask != 0; lane++, mask >>= 1)                                                    \
+            {                                                                                                    \
+                if (mask & 1)                                                                                    \
+                    hits[numHits++] = ids[k + lane];                                                             \
+            }                                                                                                    \
+        }                                                                                                        \
+        return numHits + findContactsScalar(ps, i, ids + k, count - k, minDist, hits + numHits);                 \
+    }
+
+#endif
+
+#if defined(PHYSX_SIMD_X86)
+PHYSX_DEFINE_KERNELS(SSE, PHYSX_SSE_TARGET)
+PHYSX_DEFINE_KERNELS(AVX2, PHYSX_AVX2_TARGET)
+
+static const SimdKernels sseKernels = {SimdLevel::SSE, "sse", integrateSSE, constraintSSE, findContactsSSE};
+static const SimdKernels avx2Kernels = {SimdLevel::AVX2, "avx2", integrateAVX2, constraintAVX2, findContactsAVX2};
+#elif defined(PHYSX_SIMD_NEON)
+PHYSX_DEFINE_KERNELS(NEON, )
+
+static const SimdKernels neonKernels = {SimdLevel::NEON, "neon", integrateNEON, constraintNEON, findContactsNEON};
+#endif
+
+// ------------------------------------------------------------------------
+// Dispatch
+// ------------------------------------------------------------------------
+
+bool simdSupported(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return true;
+#if defined(PHYSX_SIMD_X86)
+    case SimdLevel::SSE:
+        return true;
+    case SimdLevel::AVX2:
+#if defined(__GNUC__)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+#elif defined(PHYSX_SIMD_NEON)
+    case SimdLevel::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+const SimdKernels &simdKernels(SimdLevel level)
+{
+    if (!simdSupported(level))
+        return scalarKernels;
+
+    switch (level)
+    {
+#if defined(PHYSX_SIMD_X86)
+    case SimdLevel::SSE:
+        return sseKernels;
+    case SimdLevel::AVX2:
+        return avx2Kernels;
+#elif defined(PHYSX_SIMD_NEON)
+    case SimdLevel::NEON:
+        return neonKernels;
+#endif
+    default:
+        return scalarKernels;
+    }
+}
+
+const SimdKernels &simdKernels()
+{
+    static const SimdKernels &best = simdSupported(SimdLevel::AVX2)   ? simdKernels(SimdLevel::AVX2)
+                                     : simdSupported(SimdLevel::NEON) ? simdKernels(SimdLevel::NEON)
+                                     : simdSupported(SimdLevel::SSE)  ? simdKernels(SimdLevel::SSE)
+                                                                      : simdKernels(SimdLevel::Scalar);
+    return best;
+}
@@ -13,7 +13,7 @@ Skybox::Skybox(const std::string &hdrPath)
       cubeMap("res/models/Shapes/cube.gltf", "cubemap", false)
 {
     backgroundShader.Activate();
-    glUniform1i(glGetUniformLocation(backgroundShader.ID, "environmentMap"), 0);
+    glUniform1i(backgroundShader.uniform("environmentMap"), 0);
 
     // Initialize FBO and RBO
     glGenFramebuffers(1, &captureFBO);
@@ -63,7 +63,7 @@ void Skybox::Render(Camera &camera)
     glDepthFunc(GL_LEQUAL);
 
     backgroundShader.Activate();
-    glUniformMatrix4fv(glGetUniformLocation(backgroundShader.ID, "view"), 1, GL_FALSE, glm::value_ptr(camera.view));
+    glUniformMatrix4fv(backgroundShader.uniform("view"), 1, GL_FALSE, glm::value_ptr(camera.view));
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
     // glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
@@ -104,8 +104,8 @@ void Skybox::SetupCubemap(Camera &camera)
     // pbr: convert HDR equirectangular environment map to cubemap equivalent
     // ----------------------------------------------------------------------
     equirectangularToCubemapShader.Activate();
-    glUniform1i(glGetUniformLocation(equirectangularToCubemapShader.ID, "equirectangularMap"), 0);
-    glUniformMatrix4fv(glGetUniformLocation(equirectangularToCubemapShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(captureProjection));
+    glUniform1i(equirectangularToCubemapShader.uniform("equirectangularMap"), 0);
+    glUniformMatrix4fv(equirectangularToCubemapShader.uniform("projection"), 1, GL_FALSE, glm::value_ptr(captureProjection));
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, hdrTexture);
 
@@ -113,7 +113,7 @@ void Skybox::SetupCubemap(Camera &camera)
     glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     for (unsigned int i = 0; i < 6; ++i)
     {
-        glUniformMatrix4fv(glGetUniformLocation(equirectangularToCubemapShader.ID, "view"), 1, GL_FALSE, glm::value_ptr(captureViews[i]));
+        glUniformMatrix4fv(equirectangularToCubemapShader.uniform("view"), 1, GL_FALSE, glm::value_ptr(captureViews[i]));
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, envCubemap, 0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -145,8 +145,8 @@ void Skybox::SetupIrradiance(Camera &camera)
     // pbr: solve diffuse integral by convolution to create an irradiance (cube)map.
     // -----------------------------------------------------------------------------
     irradianceShader.Activate();
-    glUniform1i(glGetUniformLocation(irradianceShader.ID, "environmentMap"), 0);
-    glUniformMatrix4fv(glGetUniformLocation(irradianceShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(captureProjection));
+    glUniform1i(irradianceShader.uniform("environmentMap"), 0);
+    glUniformMatrix4fv(irradianceShader.uniform("projection"), 1, GL_FALSE, glm::value_ptr(captureProjection));
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
@@ -154,7 +154,7 @@ void Skybox::SetupIrradiance(Camera &camera)
     glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     for (unsigned int i = 0; i < 6; ++i)
     {
-        glUniformMatrix4fv(glGetUniformLocation(irradianceShader.ID, "view"), 1, GL_FALSE, glm::value_ptr(captureViews[i]));
+        glUniformMatrix4fv(irradianceShader.uniform("view"), 1, GL_FALSE, glm::value_ptr(captureViews[i]));
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, irradianceMap, 0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -180,8 +180,8 @@ void Skybox::SetupPrefilter(Camera &camera)
     glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
     prefilterShader.Activate();
-    glUniform1i(glGetUniformLocation(prefilterShader.ID, "environmentMap"), 0);
-    glUniformMatrix4fv(glGetUniformLocation(prefilterShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(captureProjection));
+    glUniform1i(prefilterShader.uniform("environmentMap"), 0);
+    glUniformMatrix4fv(prefilterShader.uniform("projection"), 1, GL_FALSE, glm::value_ptr(captureProjection));
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
@@ -197,10 +197,10 @@ void Skybox::SetupPrefilter(Camera &camera)
         glViewport(0, 0, mipWidth, mipHeight);
 
         float roughness = (float)mip / (float)(maxMipLevels - 1);
-        glUniform1f(glGetUniformLocation(prefilterShader.ID, "roughness"), roughness);
+        glUniform1f(prefilterShader.uniform("roughness"), roughness);
         for (unsigned int i = 0; i < 6; ++i)
         {
-            glUniformMatrix4fv(glGetUniformLocation(prefilterShader.ID, "view"), 1, GL_FALSE, glm::value_ptr(captureViews[i]));
+            glUniformMatrix4fv(prefilterShader.uniform("view"), 1, GL_FALSE, glm::value_ptr(captureViews[i]));
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, prefilterMap, mip);
 
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -236,7 +236,7 @@ void Skybox::SetupBRDF(Camera &camera)
 
     camera.updateMatrix(45.0f, 0.1f, 100.0f);
     backgroundShader.Activate();
-    glUniformMatrix4fv(glGetUniformLocation(backgroundShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(camera.projection));
+    glUniformMatrix4fv(backgroundShader.uniform("projection"), 1, GL_FALSE, glm::value_ptr(camera.projection));
 }
 
 void Skybox::RenderQuad()
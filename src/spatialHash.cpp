@@ -0,0 +1,107 @@
+#include "spatialHash.h"
+
+#include <cmath>
+
+SpatialHash::SpatialHash(float spacing, int maxNumObjs)
+{
+    SpatialHash::spacing = spacing;
+    tableSize = 2 * maxNumObjs;
+    cellStart.assign(tableSize + 1, 0);
+    particleMap.assign(maxNumObjs, 0);
+}
+
+int SpatialHash::intCoord(float coord) const
+{
+    return (int)std::floor(coord / spacing);
+}
+
+// Same primes as hashCoords in particle.comp so both paths bucket identically
+unsigned int SpatialHash::hashCoords(int xi, int yi, int zi) const
+{
+    unsigned int h = (unsigned int)xi * 92837111u ^ (unsigned int)yi * 689287499u ^ (unsigned int)zi * 283923481u;
+    return h % (unsigned int)tableSize;
+}
+
+unsigned int SpatialHash::hashPos(const glm::vec3 &pos) const
+{
+    return hashCoords(intCoord(pos.x), intCoord(pos.y), intCoord(pos.z));
+}
+
+void SpatialHash::create(int numObjs, const float *x, const float *y, const float *z)
+{
+    if (2 * numObjs > tableSize)
+        tableSize = 2 * numObjs;
+
+    cellStart.assign(tableSize + 1, 0);
+    particleMap.resize(numObjs);
+
+    // Count particles per bucket
+    for (int i = 0; i < numObjs; i++)
+        cellStart[hashCoords(intCoord(x[i]), intCoord(y[i]), intCoord(z[i]))]++;
+
+    // Partial sums, each entry now points one past the end of its bucket
+    int start = 0;
+    for (int i = 0; i < tableSize; i++)
+    {
+        start += cellStart[i];
+        cellStart[i] = start;
+    }
+    cellStart[tableSize] = start;
+
+    // Fill in the particle ids, walking every bucket start back into place
+    for (int i = 0; i < numObjs; i++)
+    {
+        unsigned int h = hashCoords(intCoord(x[i]), intCoord(y[i]), intCoord(z[i]));
+        cellStart[h]--;
+        particleMap[cellStart[h]] = i;
+    }
+}
+
+int SpatialHash::query(const glm::vec3 &pos, float maxDist, std::vector<int> &queryIds) const
+{
+    int x0 = intCoord(pos.x - maxDist);
+    int y0 = intCoord(pos.y - maxDist);
+    int z0 = intCoord(pos.z - maxDist);
+
+    int x1 = intCoord(pos.x + maxDist);
+    int y1 = intCoord(pos.y + maxDist);
+    int z1 = intCoord(pos.z + maxDist);
+
+    return queryCells(x0, y0, z0, x1, y1, z1, queryIds);
+}
+
+int SpatialHash::queryCells(int x0, int y0, int z0, int x1, int y1, int z1, std::vector<int> &queryIds) const
+{
+    queryIds.clear();
+
+    // Distinct cells can share a bucket, only visit each bucket once
+    unsigned int visited[27];
+    int numVisited = 0;
+
+    for (int xi = x0; xi <= x1; xi++)
+    {
+        for (int yi = y0; yi <= y1; yi++)
+        {
+            for (int zi = z0; zi <= z1; zi++)
+            {
+                unsigned int h = hashCoords(xi, yi, zi);
+
+                bool seen = false;
+                for (int v = 0; v < numVisited && !seen; v++)
+                    seen = visited[v] == h;
+                if (seen)
+                    continue;
+                if (numVisited < 27)
+                    visited[numVisited++] = h;
+
+                int start = cellStart[h];
+                int end = cellStart[h + 1];
+
+                for (int i = start; i < end; i++)
+                    queryIds.push_back(particleMap[i]);
+            }
+        }
+    }
+
+    return (int)queryIds.size();
+}
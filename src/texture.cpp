@@ -64,7 +64,7 @@ Texture::Texture(const char *image, const char *texType, GLuint slot)
 
 void Texture::texUnit(Shader &shader, const char *uniform, GLuint unit)
 {
-    GLuint texUni = glGetUniformLocation(shader.ID, uniform);
+    GLuint texUni = shader.uniform(uniform);
     shader.Activate();
     glUniform1i(texUni, unit);
 }